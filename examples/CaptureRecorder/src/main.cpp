@@ -0,0 +1,106 @@
+/**
+ * HT600 Capture Recorder Example
+ * * Records the raw edges of the receiver into RAM while a signal is present, then prints the
+ * recording in the corpus format of extras/corpus, so the same capture can be replayed by the
+ * corpus benchmark and the equivalence harness on a PC.
+ * The frames decoded during the capture are listed as "# decoded:" lines: check them against the
+ * buttons actually pressed and rename them to "# expected:" before adding the file to the corpus.
+ */
+
+#include <Arduino.h>
+#include <HT600.h>
+
+// --- CONFIGURATION ---
+#define RF_PIN 4
+#define FOSC HT680_330K_FOSC     // Resistor of the transmitter under test
+#define MAX_EDGES 16384          // 128 KB of edges: about 6 s of continuous frames at 330K
+#define SILENCE_US 1000000UL     // End of a recording: 1 s without a decoded frame
+#define MAX_CODES 16
+
+HT600 decoder(FOSC, 0.3f, 1, 50);
+
+HT600Edge edges[MAX_EDGES];
+volatile uint16_t edge_count = 0;
+volatile bool recording = true;
+
+struct Code {
+    uint32_t packed;
+    uint16_t copies;
+} codes[MAX_CODES];
+uint8_t code_count = 0;
+uint32_t last_frame_us = 0;
+
+void IRAM_ATTR handleInterrupt() {
+    bool level = digitalRead(RF_PIN);
+    uint32_t now = micros();
+    if (recording && edge_count < MAX_EDGES) {
+        edges[edge_count].ticks = now;
+        edges[edge_count].level = level;
+        edge_count++;
+    }
+    decoder.handleInterrupt(level, now);
+}
+
+void countFrame(const uint32_t packed) {
+    for (uint8_t i = 0; i < code_count; i++) {
+        if (codes[i].packed == packed) {
+            codes[i].copies++;
+            return;
+        }
+    }
+    if (code_count < MAX_CODES) codes[code_count++] = {packed, 1};
+}
+
+void dump() {
+    char line[48];
+    Serial.println(F("# ht600-corpus 1"));
+    Serial.println(F("# chip: ?"));
+    snprintf(line, sizeof(line), "# fosc_khz: %u", FOSC);
+    Serial.println(line);
+    Serial.println(F("# tick_us: 1"));
+    Serial.println(F("# source: real"));
+    Serial.println(F("# conditions: ?"));
+    for (uint8_t i = 0; i < code_count; i++) {
+        snprintf(line, sizeof(line), "# decoded: %08lX %u", (unsigned long)codes[i].packed, codes[i].copies);
+        Serial.println(line);
+    }
+    for (uint16_t i = 0; i < edge_count; i++) {
+        snprintf(line, sizeof(line), "%lu %u", (unsigned long)edges[i].ticks, edges[i].level);
+        Serial.println(line);
+    }
+    Serial.println(F("# end"));
+}
+
+void setup() {
+    Serial.begin(921600);
+    pinMode(RF_PIN, INPUT);
+    attachInterrupt(digitalPinToInterrupt(RF_PIN), handleInterrupt, CHANGE);
+    Serial.println(F("# HT600 capture recorder: press the buttons of the transmitter"));
+}
+
+void loop() {
+    if (decoder.available()) {
+        countFrame((uint32_t(decoder.getTristateValue(1)) << 16) | decoder.getReceivedValue(0));
+        decoder.releaseFrame(); // Read before the next pilot ends: the copies of a held button are all counted
+        last_frame_us = micros();
+    }
+
+    // Keep only the noise just before the first frame
+    if (code_count == 0 && edge_count > MAX_EDGES / 8) {
+        noInterrupts();
+        edge_count = 0;
+        interrupts();
+    }
+
+    bool full = edge_count >= MAX_EDGES;
+    bool silent = code_count > 0 && micros() - last_frame_us > SILENCE_US;
+    if (full || silent) {
+        recording = false;
+        dump();
+        code_count = 0;
+        noInterrupts();
+        edge_count = 0;
+        recording = true;
+        interrupts();
+    }
+}
@@ -0,0 +1,119 @@
+/**
+ * HT600 ISR Benchmark
+ * * Feeds a synthetic transmission to the same kind of ISR wrapper used in BasicScanner and
+ * measures the CPU cycles spent for each edge:
+ * - AVR:   Timer1 running at F_CPU (no prescaler), one count per cycle.
+ * - ESP32: Xtensa cycle counter (ESP.getCycleCount()).
+ * * Build it once as is (out-of-line call into HT600.cpp) and once with -DHT600_HEADER_ONLY
+ * (decoder inlined into the wrapper): the difference of the "decoder" lines is the cost of the
+ * call, register save/restore included. The "empty" line is the measurement overhead.
+ * * Status: not done. No results are published yet: the README table stays "not measured" until
+ * the numbers printed here are taken on real AVR and ESP32 boards.
+ */
+
+#include <Arduino.h>
+#include <HT600.h>
+
+#define FRAMES 200
+#define TEST_VALUE 0x5A3C  // 16 trits: '1' where set, '0' elsewhere
+
+HT600 decoder(HT680_330K_FOSC, 0.3f, 1, 50);
+
+// Same shape as the user ISR of BasicScanner, but with the pin state and timestamp as parameters.
+// noinline keeps the wrapper a real function, as an ISR would be.
+void IRAM_ATTR __attribute__((noinline)) handleEdge(const bool pinState, const uint32_t ticks) {
+    decoder.handleInterrupt(pinState, ticks);
+}
+
+void IRAM_ATTR __attribute__((noinline)) emptyEdge(const bool pinState, const uint32_t ticks) {
+    asm volatile("" :: "r"(pinState), "r"(ticks));
+}
+
+#if defined(__AVR__)
+    static inline void startCycleCounter() { TCCR1A = 0; TCCR1B = _BV(CS10); }
+    static inline uint16_t readCycleCounter() { return TCNT1; }
+    typedef uint16_t cycles_t;
+#elif defined(ESP32)
+    static inline void startCycleCounter() {}
+    static inline uint32_t readCycleCounter() { return ESP.getCycleCount(); }
+    typedef uint32_t cycles_t;
+#else
+    #error "Unsupported platform"
+#endif
+
+// Builds the edges of one transmission (pilot, SYNC, 18 trits) and feeds them to the wrapper.
+// Returns the total number of cycles spent inside the wrapper.
+uint32_t runFrame(void (*wrapper)(const bool, const uint32_t), uint32_t &ticks, uint16_t &edges) {
+    const uint32_t T = 33000UL / HT680_330K_FOSC;
+    uint32_t total = 0;
+
+    // Symbols: 2 SYNC bits (SYMBOL0 + SYMBOL1), then 16 trits + 2 dummy '0' trits
+    bool symbols[40];
+    for (uint8_t i = 0; i < 2; i++) { symbols[i * 2] = 0; symbols[i * 2 + 1] = 1; }
+    for (uint8_t i = 0; i < 18; i++) {
+        bool one = (i < 16) && (TEST_VALUE & (1 << i));
+        symbols[4 + i * 2] = one;
+        symbols[5 + i * 2] = one;
+    }
+
+    // The pilot LOW ends with a rising edge, then each symbol is a LOW + HIGH pair
+    // (the first SYNC HIGH is the short pulse right after the pilot)
+    uint32_t low = 36 * T, high = T;
+    for (int8_t i = -1; i < 40; i++) {
+        if (i >= 0) {
+            low  = symbols[i] ? 2 * T : T;
+            high = symbols[i] ? T : 2 * T;
+        }
+        ticks += low;
+        cycles_t start = readCycleCounter();
+        wrapper(true, ticks);
+        total += cycles_t(readCycleCounter() - start);
+
+        ticks += high;
+        start = readCycleCounter();
+        wrapper(false, ticks);
+        total += cycles_t(readCycleCounter() - start);
+        edges += 2;
+    }
+    return total;
+}
+
+void setup() {
+    Serial.begin(115200);
+    startCycleCounter();
+
+#if defined(HT600_HEADER_ONLY)
+    Serial.println(F("\n=== HT600 ISR benchmark (header-only, inlined) ==="));
+#else
+    Serial.println(F("\n=== HT600 ISR benchmark (out-of-line call) ==="));
+#endif
+}
+
+void loop() {
+    uint32_t ticks = 0;
+    uint32_t empty_cycles = 0, decoder_cycles = 0;
+    uint16_t edges = 0, frames = 0;
+
+    noInterrupts();
+    for (uint16_t i = 0; i < FRAMES; i++) {
+        empty_cycles += runFrame(emptyEdge, ticks, edges);
+    }
+    edges = 0;
+    for (uint16_t i = 0; i < FRAMES; i++) {
+        decoder_cycles += runFrame(handleEdge, ticks, edges);
+        if (decoder.available()) {
+            if (decoder.getReceivedValue() == TEST_VALUE) frames++;
+            decoder.releaseFrame(); // Keeps the timestamp: the next frame follows right away
+        }
+    }
+    interrupts();
+
+    Serial.print(F("Frames decoded: "));
+    Serial.println(frames); // FRAMES - 1: the first pilot has no edge before it to be measured from
+    Serial.print(F("Cycles per edge, empty:   "));
+    Serial.println(float(empty_cycles) / edges, 1);
+    Serial.print(F("Cycles per edge, decoder: "));
+    Serial.println(float(decoder_cycles) / edges, 1);
+
+    delay(5000);
+}
@@ -0,0 +1,60 @@
+/**
+ * HT600/HT680 RP2040 PIO Capture Example
+ * * The receiver output is sampled by a PIO state machine which pushes every LOW and HIGH
+ * length into a DMA ring buffer. loop() feeds the decoder with the pulses captured since the
+ * last call: no interrupt is taken per edge, whatever the noise on the receiver.
+ */
+
+#include <Arduino.h>
+#include <HT600Pio.h>
+
+// Receiver data pin (any GPIO)
+#define RF_PIN 2
+
+// --- DECODER SETTINGS ---
+// The PIO counter runs at a rate derived from the oscillator (390K resistor) and from F_CPU,
+// so that the pilot window uses the full 16-bit range. The clock divider comes from PioClock.
+typedef HT600PioClock<HT680_390K_FOSC, 30> PioClock;
+typedef HT600Decoder<HT600FixedTiming<HT680_390K_FOSC, 30, PioClock>, HT600TrinaryOutput, HT600NoStats, HT600FixedFilter<50, PioClock>> Decoder;
+
+Decoder decoder;
+HT600PioCapture<Decoder> capture; // 256 pulses of buffering
+
+void setup() {
+    Serial.begin(115200);
+
+    if (!capture.begin(RF_PIN, PioClock::DIV_INT, PioClock::DIV_FRAC)) {
+        Serial.println(F("No PIO state machine or DMA channel available"));
+        while (true) delay(1000);
+    }
+
+    Serial.println(F("\n=== HT600/HT680 PIO Capture ==="));
+    Serial.print(F("Clock divider: "));
+    Serial.print(PioClock::DIV_INT);
+    Serial.print('+');
+    Serial.print(PioClock::DIV_FRAC);
+    Serial.println(F("/256"));
+}
+
+void loop() {
+    capture.poll(decoder);
+
+    if (decoder.available()) {
+        Serial.print(F("[RECV] 0x"));
+        Serial.print(decoder.getReceivedValue(), HEX);
+        Serial.print(F(" Z: 0x"));
+        Serial.println(decoder.getTristateValue(), HEX);
+
+        // Back to IDLE: the next poll() resumes with the pulses left in the ring (the timestamp is kept,
+        // so the next copy of a held button is decoded too)
+        decoder.releaseFrame();
+    }
+
+    // loop() too slow for the ring: increase RING_BITS or poll more often
+    static uint16_t overruns = 0;
+    if (capture.getOverrunCount() != overruns) {
+        overruns = capture.getOverrunCount();
+        Serial.print(F("[WARN] Ring overruns: "));
+        Serial.println(overruns);
+    }
+}
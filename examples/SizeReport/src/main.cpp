@@ -0,0 +1,57 @@
+/**
+ * HT600 Size Report
+ * * Minimal sketch used to measure the flash and RAM cost of each decoder composition.
+ * * The composition is selected with -DHT600_SIZE_CONFIG (see platformio.ini):
+ * 0: No decoder (baseline, subtract it from the other reports)
+ * 1: HT600 (default composition)
+ * 2: HT600 + HT600Stats
+ * 3: Compile-time timing and filter, packed output
+ * 4: Compile-time timing, packed output, no filter
+ * 5: HT600Compact (compile-time timing and filter, packed output, packed state)
+ */
+
+#include <Arduino.h>
+#include <HT600.h>
+
+#define RF_PIN 2
+
+#ifndef HT600_SIZE_CONFIG
+  #define HT600_SIZE_CONFIG 1
+#endif
+
+#if HT600_SIZE_CONFIG == 1
+    HT600 decoder(HT680_330K_FOSC, 0.3f, 1, 50);
+#elif HT600_SIZE_CONFIG == 2
+    HT600Decoder<HT600RuntimeTiming, HT600TrinaryOutput, HT600Stats, HT600RuntimeFilter> decoder(HT680_330K_FOSC, 0.3f, 1, 50);
+#elif HT600_SIZE_CONFIG == 3
+    HT600Decoder<HT600FixedTiming<HT680_330K_FOSC>, HT600PackedOutput, HT600NoStats, HT600FixedFilter<50>> decoder;
+#elif HT600_SIZE_CONFIG == 4
+    HT600Decoder<HT600FixedTiming<HT680_330K_FOSC>, HT600PackedOutput, HT600NoStats, HT600NoFilter> decoder;
+#elif HT600_SIZE_CONFIG == 5
+    HT600Compact<HT680_330K_FOSC> decoder;
+#endif
+
+// Keeps the result alive so that the compiler can not drop the decoder
+volatile uint16_t received;
+
+#if HT600_SIZE_CONFIG != 0
+void handleInterrupt() {
+    decoder.handleInterrupt(digitalRead(RF_PIN), micros());
+}
+#endif
+
+void setup() {
+    pinMode(RF_PIN, INPUT);
+#if HT600_SIZE_CONFIG != 0
+    attachInterrupt(digitalPinToInterrupt(RF_PIN), handleInterrupt, CHANGE);
+#endif
+}
+
+void loop() {
+#if HT600_SIZE_CONFIG != 0
+    if (decoder.available()) {
+        received = decoder.getReceivedValue() ^ decoder.getTristateValue();
+        decoder.resetAvailable();
+    }
+#endif
+}
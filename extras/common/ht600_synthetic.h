@@ -0,0 +1,93 @@
+#ifndef HT600_SYNTHETIC_H
+#define HT600_SYNTHETIC_H
+
+/**
+ * Synthetic HT600 waveforms (host)
+ * * Builds the edges of pilots, trits and noise pulses with receiver and transmitter impairments.
+ * Shared by the equivalence harness (extras/equivalence) and the corpus benchmark (extras/corpus), so
+ * that both generate the same waveform for the same trits, impairments and random sequence.
+ * Header only: include it as "../common/ht600_synthetic.h", no extra build flag.
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "HT600.h"
+
+// Trits as sent by the encoder: the two symbols of a bit are (ONE || FLOAT, ONE || SYNC)
+enum HT600SyntheticTrit : uint8_t {
+    TRIT_ZERO  = 0,
+    TRIT_ONE   = 1,
+    TRIT_FLOAT = 2, // 'Z'
+    TRIT_SYNC  = 3  // First two bits of a frame (invalid anywhere else)
+};
+
+// Receiver and transmitter impairments applied to the ideal waveform
+struct HT600Impairments {
+    double jitter = 0;   // Relative jitter of each pulse
+    double bias_us = 0;  // HIGH stretch of the receiver (negative: LOW stretch)
+    double glitch_p = 0; // Probability of a spike inside each pulse (noisy receiver)
+    double drop_p = 0;   // Probability of a lost pulse pair (weak signal)
+};
+
+/**
+ * @brief Appends pulses to a list of edges, each edge being the transition at the end of a pulse.
+ * Every random draw comes from the generator given to the constructor, in the order of the calls, so
+ * that the caller can interleave its own draws (codes, frame lengths) and stay reproducible.
+ */
+class HT600Waveform {
+    public:
+        HT600Waveform(std::mt19937 &rng, const HT600Impairments &impairments, const double start = 0)
+            : t(start), _rng(rng), _impairments(impairments) {}
+
+        // Pulse of the given level and nominal length, ended by a transition to the other level
+        void pulse(const bool high, double length) {
+            length += high ? _impairments.bias_us : -_impairments.bias_us;
+            length *= 1.0 + _impairments.jitter * (2 * _unit(_rng) - 1);
+            if (_unit(_rng) < _impairments.glitch_p) {
+                // Spike of the opposite level in the middle of the pulse
+                double spike = 5 + 35 * _unit(_rng);
+                t += length / 2;
+                edges.push_back({uint32_t(t), !high});
+                t += spike;
+                edges.push_back({uint32_t(t), high});
+                length = length / 2 - spike;
+            }
+            t += std::max(1.0, length);
+            edges.push_back({uint32_t(t), !high});
+        }
+
+        // LOW then HIGH: 2T + 1T for a 1, 1T + 2T for a 0
+        void symbol(const bool one, const double T) {
+            if (_unit(_rng) < _impairments.drop_p) {
+                // Lost pair: both pulses merge into one LOW
+                pulse(false, 3 * T);
+                pulse(true, 0);
+                return;
+            }
+            pulse(false, one ? 2 * T : T);
+            pulse(true, one ? T : 2 * T);
+        }
+
+        void trit(const uint8_t trit, const double T) {
+            symbol(trit == TRIT_ONE || trit == TRIT_FLOAT, T);
+            symbol(trit == TRIT_ONE || trit == TRIT_SYNC, T);
+        }
+
+        // 36T LOW + 1T HIGH
+        void pilot(const double T) {
+            pulse(false, 36 * T);
+            pulse(true, T);
+        }
+
+        std::vector<HT600Edge> edges;
+        double t; // End of the last pulse, in ticks
+
+    private:
+        std::mt19937 &_rng;
+        HT600Impairments _impairments;
+        std::uniform_real_distribution<double> _unit{0.0, 1.0};
+};
+
+#endif
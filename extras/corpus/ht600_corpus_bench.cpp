@@ -0,0 +1,304 @@
+/**
+ * HT600 corpus benchmark (host)
+ * * Decodes labelled recordings and reports, for each one, the decode rate (expected frames found),
+ * the wrong frames (decoded but not expected) and the decoding time per edge, with the default decoder
+ * and with the asymmetry-compensating filter.
+ *
+ * Build:  g++ -std=c++17 -O2 -I../../src ht600_corpus_bench.cpp ../../src/HT600.cpp -o ht600_corpus_bench
+ * Run:    ./ht600_corpus_bench recording.txt ...    Real recordings (see the format below)
+ *         ./ht600_corpus_bench                      Built-in SYNTHETIC set (one per chip/condition)
+ *         ./ht600_corpus_bench -g dir               Writes the synthetic set to dir, in the same format
+ *
+ * Recording format (text, one per file): header lines starting with '#', then one edge per line,
+ * "<ticks> <level>" (same as the equivalence harness, extras/equivalence).
+ *   # ht600-corpus 1
+ *   # chip: HT680                      HT600, HT680 or HT6207
+ *   # fosc_khz: 100                    HT680_*_FOSC value of the transmitter resistor
+ *   # tick_us: 1                       Length of a tick
+ *   # source: real                     real or synthetic
+ *   # conditions: 10 m, fresh battery  Free text (distance, battery, receiver model...)
+ *   # expected: 0003A5F0 12            Expected frame (HT600Frame::packed(), hex) and number of copies
+ * The examples/CaptureRecorder sketch prints recordings in this format.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "HT600.h"
+#include "../common/ht600_synthetic.h"
+
+namespace {
+
+struct Recording {
+    std::string name;
+    std::string chip = "?";
+    uint16_t fosc = HT680_330K_FOSC;
+    uint16_t tick_us = 1;
+    std::string source = "?";
+    std::string conditions;
+    std::map<uint32_t, uint32_t> expected; // packed -> copies
+    std::vector<HT600Edge> edges;
+};
+
+struct Score {
+    uint32_t found = 0; // Expected frames decoded (up to the expected copies)
+    uint32_t wrong = 0; // Decoded frames that were not expected
+    double ns_per_edge = 0;
+};
+
+
+// ------------------------------------------------------------------------------------------------
+// FORMAT
+// ------------------------------------------------------------------------------------------------
+
+std::string trim(const std::string &text) {
+    size_t begin = text.find_first_not_of(" \t\r"), end = text.find_last_not_of(" \t\r");
+    return begin == std::string::npos ? "" : text.substr(begin, end - begin + 1);
+}
+
+bool load(const std::string &path, Recording &recording) {
+    std::ifstream in(path);
+    if (!in) return false;
+    recording = Recording();
+    recording.name = path.substr(path.find_last_of('/') + 1);
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        if (line[0] == '#') {
+            size_t colon = line.find(':');
+            if (colon == std::string::npos) continue;
+            std::string key = trim(line.substr(1, colon - 1)), value = trim(line.substr(colon + 1));
+            if (key == "chip") recording.chip = value;
+            else if (key == "fosc_khz") recording.fosc = uint16_t(atoi(value.c_str()));
+            else if (key == "tick_us") recording.tick_us = uint16_t(atoi(value.c_str()));
+            else if (key == "source") recording.source = value;
+            else if (key == "conditions") recording.conditions = value;
+            else if (key == "expected") {
+                std::istringstream fields(value);
+                uint32_t packed, copies = 1;
+                if (fields >> std::hex >> packed) {
+                    fields >> std::dec >> copies;
+                    recording.expected[packed] += copies;
+                }
+            }
+            continue;
+        }
+        std::istringstream fields(line);
+        uint32_t ticks;
+        int level;
+        if (fields >> ticks >> level) recording.edges.push_back({ticks, level != 0});
+    }
+    return true;
+}
+
+void save(const Recording &recording, const std::string &path) {
+    std::ofstream out(path);
+    out << "# ht600-corpus 1\n"
+        << "# chip: " << recording.chip << "\n"
+        << "# fosc_khz: " << recording.fosc << "\n"
+        << "# tick_us: " << recording.tick_us << "\n"
+        << "# source: " << recording.source << "\n"
+        << "# conditions: " << recording.conditions << "\n";
+    char text[32];
+    for (const auto &expected : recording.expected) {
+        snprintf(text, sizeof(text), "%08X %u", expected.first, expected.second);
+        out << "# expected: " << text << "\n";
+    }
+    for (const auto &edge : recording.edges) out << edge.ticks << ' ' << int(edge.level) << '\n';
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// SYNTHETIC SET
+// ------------------------------------------------------------------------------------------------
+
+// Receiver and transmitter impairments of one synthetic recording
+struct Conditions {
+    const char *text;
+    double drift;             // Relative change of T from the first to the last frame (battery sag: fosc drops)
+    int gap_noise;            // Noise pulses between presses
+    HT600Impairments impairments;
+};
+
+// Random code with the trits of the chip: address 0/1/Z, data 0/1, unbonded trits Z
+uint32_t randomCode(std::mt19937 &rng, const uint16_t address_mask, const uint16_t data_mask) {
+    uint16_t value = 0, z = 0;
+    for (uint8_t i = 0; i < 16; i++) {
+        uint16_t bit = uint16_t(1) << i;
+        if (address_mask & bit) {
+            uint32_t trit = rng() % 3;
+            if (trit == 1) value |= bit;
+            if (trit == 2) z |= bit;
+        } else if (data_mask & bit) {
+            if (rng() & 1) value |= bit;
+        } else {
+            z |= bit;
+        }
+    }
+    return (uint32_t(z) << 16) | value;
+}
+
+Recording synthesize(const char *chip, const uint16_t fosc, const Conditions &conditions, const uint32_t seed) {
+    uint16_t address_mask = HT600_ADDRESS_MASK, data_mask = HT600_DATA_MASK;
+    if (std::string(chip) == "HT680") { address_mask = HT680_ADDRESS_MASK; data_mask = HT680_DATA_MASK; }
+    if (std::string(chip) == "HT6207") { address_mask = HT6207_ADDRESS_MASK; data_mask = HT6207_DATA_MASK; }
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    Recording recording;
+    recording.chip = chip;
+    recording.fosc = fosc;
+    recording.source = "synthetic";
+    recording.conditions = conditions.text;
+
+    const int presses = 12;
+    const double T0 = 33000.0 / fosc;
+    HT600Waveform wave(rng, conditions.impairments, 100000);
+
+    // The recording starts on an idle LOW line, as a capture does: the first pilot is measured from this edge
+    wave.edges.push_back({uint32_t(wave.t), false});
+
+    for (int p = 0; p < presses; p++) {
+        uint32_t code = randomCode(rng, address_mask, data_mask);
+        uint16_t value = uint16_t(code), z = uint16_t(code >> 16);
+        int copies = 3 + int(rng() % 4);
+        recording.expected[code] += copies;
+
+        for (int c = 0; c < copies; c++) {
+            double T = T0 * (1.0 + conditions.drift * (p * 8 + c) / (presses * 8.0));
+            wave.pilot(T);
+            for (int i = 0; i < 20; i++) {
+                // SYNC, 16 trits, 2 dummy trits (Z)
+                wave.trit((i < 2) ? TRIT_SYNC : (i >= 18) ? TRIT_FLOAT : (z >> (i - 2) & 1) ? TRIT_FLOAT : (value >> (i - 2) & 1), T);
+            }
+        }
+        // Release: silence with receiver noise
+        for (int n = 0; n < conditions.gap_noise; n++) {
+            wave.pulse(false, 200 + 3000 * unit(rng));
+            wave.pulse(true, 5 + 200 * unit(rng));
+        }
+        wave.pulse(false, 150000 + 100000 * unit(rng));
+        wave.pulse(true, 20);
+    }
+    recording.edges = wave.edges;
+
+    char name[96];
+    snprintf(name, sizeof(name), "synthetic_%s_fosc%u_%u.txt", chip, fosc, seed);
+    recording.name = name;
+    return recording;
+}
+
+std::vector<Recording> syntheticSet() {
+    // {jitter, bias_us, glitch_p, drop_p}
+    const Conditions strong   = {"SYNTHETIC strong signal", 0, 0, {0.03, 0, 0, 0}};
+    const Conditions weak     = {"SYNTHETIC weak signal (jitter, lost pulses, noise)", 0, 20, {0.12, 0, 0.002, 0.004}};
+    const Conditions sag      = {"SYNTHETIC battery sag (fosc -15% over the recording)", 0.18, 0, {0.04, 0, 0, 0}};
+    const Conditions noisy    = {"SYNTHETIC noisy receiver (spikes)", 0, 40, {0.05, 0, 0.01, 0}};
+    const Conditions biased   = {"SYNTHETIC asymmetric receiver (+90us HIGH)", 0, 5, {0.04, 90, 0, 0}};
+
+    return {
+        synthesize("HT600",  HT680_330K_FOSC, strong, 1),
+        synthesize("HT680",  HT680_390K_FOSC, strong, 2),
+        synthesize("HT6207", HT680_1M0_FOSC,  strong, 3),
+        synthesize("HT680",  HT680_120K_FOSC, weak,   4),
+        synthesize("HT600",  HT680_330K_FOSC, weak,   5),
+        synthesize("HT6207", HT680_470K_FOSC, sag,    6),
+        synthesize("HT680",  HT680_1M5_FOSC,  sag,    7),
+        synthesize("HT600",  HT680_220K_FOSC, noisy,  8),
+        synthesize("HT680",  HT680_330K_FOSC, biased, 9),
+    };
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// BENCHMARK
+// ------------------------------------------------------------------------------------------------
+
+template <class Decoder>
+Score score(const Recording &recording, const Decoder &prototype) {
+    Score result;
+    double best = 1e30;
+    for (int r = 0; r < 5; r++) {
+        Decoder decoder = prototype;
+        std::map<uint32_t, uint32_t> remaining = recording.expected;
+        Score current;
+        auto start = std::chrono::steady_clock::now();
+        for (const auto &edge : recording.edges) {
+            decoder.handleInterrupt(edge.level, edge.ticks);
+            if (!decoder.available()) continue;
+            uint32_t packed = (uint32_t(decoder.getTristateValue(1)) << 16) | decoder.getReceivedValue(0);
+            decoder.releaseFrame(); // Keeps the timestamp: back-to-back copies are scored too
+            auto it = remaining.find(packed);
+            if (it != remaining.end() && it -> second > 0) {
+                it -> second--;
+                current.found++;
+            } else if (it == remaining.end()) {
+                current.wrong++;
+            }
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, ns);
+        result = current;
+    }
+    result.ns_per_edge = recording.edges.empty() ? 0 : best / recording.edges.size();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::vector<Recording> recordings;
+    std::string generate;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-g" && i + 1 < argc) {
+            generate = argv[++i];
+            continue;
+        }
+        Recording recording;
+        if (!load(arg, recording)) {
+            fprintf(stderr, "Cannot open %s\n", arg.c_str());
+            return 2;
+        }
+        recordings.push_back(recording);
+    }
+
+    if (!generate.empty()) {
+        for (const auto &recording : syntheticSet()) save(recording, generate + "/" + recording.name);
+        printf("Synthetic set written to %s\n", generate.c_str());
+        return 0;
+    }
+    if (recordings.empty()) {
+        printf("No recording given: built-in SYNTHETIC set (generated waveforms, not real captures)\n");
+        recordings = syntheticSet();
+    }
+
+    printf("\n%-34s %-6s %4s %7s %13s %13s %8s  %s\n", "recording", "chip", "fosc", "frames", "rate default", "rate comp.", "ns/edge", "conditions");
+    for (const auto &recording : recordings) {
+        uint32_t expected = 0;
+        for (const auto &e : recording.expected) expected += e.second;
+
+        HT600 plain(recording.fosc, HT600_TOLERANCE, recording.tick_us, 50);
+        HT600Decoder<HT600RuntimeTiming, HT600TrinaryOutput, HT600NoStats, HT600CompensatingFilter<true>> compensated(recording.fosc, HT600_TOLERANCE, recording.tick_us, 50);
+        Score a = score(recording, plain), b = score(recording, compensated);
+
+        char rate_a[32], rate_b[32];
+        snprintf(rate_a, sizeof(rate_a), "%5.1f%% (%u!)", expected ? 100.0 * a.found / expected : 0.0, a.wrong);
+        snprintf(rate_b, sizeof(rate_b), "%5.1f%% (%u!)", expected ? 100.0 * b.found / expected : 0.0, b.wrong);
+        printf("%-34s %-6s %4u %7u %13s %13s %8.1f  %s [%s]\n", recording.name.c_str(), recording.chip.c_str(), recording.fosc, expected,
+               rate_a, rate_b, a.ns_per_edge, recording.conditions.c_str(), recording.source.c_str());
+    }
+    printf("\nrate: expected frames decoded; (n!): frames decoded that were not expected\n");
+    return 0;
+}
@@ -0,0 +1,897 @@
+/**
+ * HT600 equivalence harness (host)
+ * * Runs every decoder implementation over the same corpora and checks that they produce exactly the
+ * frames (timestamp, value, Z mask) and the stats counters of the reference, HT600::handleInterrupt
+ * called on each edge. Also reports the speed of each implementation relative to the reference.
+ *
+ * Build:  g++ -std=c++20 -O2 -I../../src ht600_equivalence.cpp ../../src/HT600.cpp -o ht600_equivalence
+ * Run:    ./ht600_equivalence [-s seed] [-f fosc_khz capture.txt ...]
+ *
+ * Timing windows: HT600RuntimeTiming over every HT680_*_FOSC, tolerance and tick length (1ns to 4us)
+ * must give ordered windows, each within one prescaled tick of its nominal length, with the smallest
+ * shift that fits 16 bits. HT600ClockTiming must match it (or refuse 16-bit clocks that would need
+ * prescaling), and HT600FixedTiming must give exactly the same windows.
+ *
+ * DMA capture: HT600DmaCapture (the poll() of HT600PioCapture) runs against a model of the PIO RX FIFO
+ * and of the DMA channel, with short runs and a small ring. Every pulse pushed must reach the decoder
+ * once and in order, through ring wraps, runs that run out between two polls and re-arms while pulses
+ * wait in the FIFO. The same path also decodes the corpora, like the other implementations.
+ *
+ * Corpora:
+ * - synthetic: generated frames (jitter, invalid trits, noise bursts) for several oscillators, with the
+ *              waveform generator shared with the corpus benchmark (extras/common/ht600_synthetic.h);
+ * - repeated:  a held button, 100 back-to-back copies of one frame: the reference must find all of them
+ *              (frames are read with releaseFrame(), which keeps the timestamp for the next pilot).
+ * - fuzz:      random pulse lengths around the symbol windows, with and without alternating levels;
+ * - captures:  text files given with -f, one edge per line: "<ticks> <level>" (1us ticks, '#' comments).
+ * Every corpus is shifted so that its first edge is at 2^24 ticks: the decoders start from a reset
+ * state, and the first delta saturates the same way for all of them.
+ * - wrap:      synthetic corpora again, shifted so that the 32-bit counter wraps inside a pulse of a
+ *              complete frame. Besides the comparison, the reference must find the same frames and
+ *              counters as on the unshifted corpus (with and without prescaling: HT680_1M5_FOSC and
+ *              HT680_2M0_FOSC need a shift with 1us ticks).
+ *
+ * Exit code: 0 if every implementation matches, 1 otherwise.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "HT600.h"
+#include "HT600Pio.h"
+#include "HT600Ranges.h"
+#include "../common/ht600_synthetic.h"
+
+namespace {
+
+typedef std::vector<HT600Edge> Edges;
+
+struct Corpus {
+    std::string name;
+    uint16_t fosc;
+    Edges edges;
+    uint32_t wrap_offset = 0; // Not 0: shift from the same corpus based at 2^24, whose frames must be found too
+    size_t copies = 0;        // Not 0: back-to-back copies of one frame, which must all be found
+};
+
+// Frames and counters produced by one implementation
+struct Result {
+    std::vector<HT600Frame> frames;
+    uint32_t counters[6] = {0, 0, 0, 0, 0, 0}; // glitch, pilot, timing, sync, symbol, frame
+    bool has_counters = false;
+    double ns_per_edge = 0;
+};
+
+// Requirements of an implementation on the corpus
+enum Needs : uint8_t {
+    ANY         = 0,
+    ALTERNATING = 1, // Pulse lengths input: the levels must alternate
+    SHORT_GAPS  = 2  // HT600CompactState: no gap above 65535 (prescaled) ticks
+};
+
+struct Implementation {
+    std::string name;
+    uint8_t needs;
+    std::function<Result(const Edges &)> run;
+};
+
+const uint32_t REPEAT = 3; // Timed runs (the best one is kept)
+const float TOLERANCE = 0.3f;
+const uint16_t NOISE_US = 50;
+
+
+// ------------------------------------------------------------------------------------------------
+// CORPORA
+// ------------------------------------------------------------------------------------------------
+
+void rebase(Edges &edges) {
+    if (edges.empty()) return;
+    uint32_t offset = (uint32_t(1) << 24) - edges.front().ticks;
+    for (auto &edge : edges) edge.ticks += offset;
+}
+
+// Same corpus, moved so that the 32-bit counter wraps around in the middle of a pulse of a complete
+// frame (the first one after the middle of the corpus)
+Corpus wrapped(const Corpus &corpus) {
+    Corpus result = corpus;
+    const Edges &edges = corpus.edges;
+    const uint32_t pilot = uint32_t(30 * 33000.0 / corpus.fosc);
+    size_t start = edges.size() / 2;
+    for (size_t i = start; i + 82 < edges.size(); i++) {
+        bool complete = edges[i].ticks - edges[i - 1].ticks > pilot;
+        for (size_t k = i + 1; complete && k < i + 82; k++) complete = edges[k].ticks - edges[k - 1].ticks <= pilot;
+        if (complete) {
+            start = i + 40;
+            break;
+        }
+    }
+    if (start == 0 || start >= edges.size()) return result;
+
+    // Multiple of 16: the prescaled timestamps (shift up to 4) round the same way as on the unshifted corpus
+    result.wrap_offset = (0 - (edges[start - 1].ticks + (edges[start].ticks - edges[start - 1].ticks) / 2)) & ~uint32_t(15);
+    for (auto &edge : result.edges) edge.ticks += result.wrap_offset;
+    result.name += ", across the 32-bit wrap";
+    return result;
+}
+
+Corpus synthetic(const uint16_t fosc, const uint32_t seed, const int frames) {
+    std::mt19937 rng(seed);
+    HT600Impairments impairments;
+    impairments.jitter = 0.12;
+    HT600Waveform wave(rng, impairments);
+    double T = 33000.0 / fosc;
+
+    for (int f = 0; f < frames; f++) {
+        wave.pilot(T);
+        int length = (rng() % 8 == 0) ? int(rng() % 20) : 20; // Some truncated frames
+        for (int i = 0; i < length; i++) {
+            uint8_t trit = (i < 2) ? TRIT_SYNC : uint8_t(rng() % 3);
+            if (i >= 2 && rng() % 40 == 0) trit = TRIT_SYNC; // Invalid trit (SYNC pattern in the payload)
+            wave.trit(trit, T);
+        }
+        int noise = int(rng() % 6);
+        for (int n = 0; n < noise; n++) {
+            wave.pulse(false, 5 + rng() % 400);
+            wave.pulse(true, 5 + rng() % 400);
+        }
+    }
+    rebase(wave.edges);
+    return {"synthetic fosc=" + std::to_string(fosc), fosc, wave.edges};
+}
+
+// A held button: back-to-back copies of one frame, after an idle LOW line
+Corpus repeated(const uint16_t fosc, const uint32_t seed, const size_t copies) {
+    std::mt19937 rng(seed);
+    HT600Impairments impairments;
+    impairments.jitter = 0.05;
+    HT600Waveform wave(rng, impairments);
+    double T = 33000.0 / fosc;
+    wave.edges.push_back({0, false});
+
+    uint8_t trits[20];
+    for (int i = 0; i < 20; i++) trits[i] = (i < 2) ? TRIT_SYNC : uint8_t(rng() % 3);
+    for (size_t c = 0; c < copies; c++) {
+        wave.pilot(T); // Right after the last bit of the previous copy
+        for (uint8_t trit : trits) wave.trit(trit, T);
+    }
+    rebase(wave.edges);
+    Corpus corpus = {"repeated frame fosc=" + std::to_string(fosc), fosc, wave.edges};
+    corpus.copies = copies;
+    return corpus;
+}
+
+Corpus fuzz(const uint16_t fosc, const uint32_t seed, const size_t count, const bool alternating) {
+    std::mt19937 rng(seed);
+    double T = 33000.0 / fosc;
+    std::uniform_real_distribution<double> near(0.6, 1.4);
+    uint32_t t = 0;
+    bool level = false;
+    Edges edges;
+
+    for (size_t i = 0; i < count; i++) {
+        double length;
+        switch (rng() % 5) {
+            case 0:  length = T * near(rng); break;
+            case 1:  length = 2 * T * near(rng); break;
+            case 2:  length = 36 * T * near(rng); break;
+            case 3:  length = 1 + rng() % NOISE_US * 2; break;
+            default: length = 1 + rng() % uint32_t(3 * T); break;
+        }
+        t += uint32_t(length);
+        level = alternating ? !level : bool(rng() & 1);
+        edges.push_back({t, level});
+    }
+    rebase(edges);
+    return {std::string(alternating ? "fuzz alternating" : "fuzz raw levels") + " fosc=" + std::to_string(fosc), fosc, edges};
+}
+
+bool loadCapture(const std::string &path, const uint16_t fosc, Corpus &corpus) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    corpus = {"capture " + path + " fosc=" + std::to_string(fosc), fosc, {}};
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        uint32_t ticks;
+        int level;
+        if (fields >> ticks >> level) corpus.edges.push_back({ticks, level != 0});
+    }
+    rebase(corpus.edges);
+    return true;
+}
+
+bool isAlternating(const Edges &edges) {
+    for (size_t i = 1; i < edges.size(); i++) {
+        if (edges[i].level == edges[i - 1].level) return false;
+    }
+    return true;
+}
+
+uint32_t maxGap(const Edges &edges) {
+    uint32_t gap = 0;
+    for (size_t i = 1; i < edges.size(); i++) gap = std::max(gap, edges[i].ticks - edges[i - 1].ticks);
+    return gap;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// IMPLEMENTATIONS
+// ------------------------------------------------------------------------------------------------
+
+template <class Decoder>
+void readFrame(Decoder &decoder, const uint32_t ticks, Result &result) {
+    result.frames.push_back({ticks, decoder.getReceivedValue(0), decoder.getTristateValue(1)});
+    decoder.releaseFrame();
+}
+
+template <class Decoder>
+void addCounters(const Decoder &decoder, Result &result) {
+    result.counters[0] += decoder.getGlitchCount();
+    result.counters[1] += decoder.getPilotCount();
+    result.counters[2] += decoder.getTimingRejectCount();
+    result.counters[3] += decoder.getSyncRejectCount();
+    result.counters[4] += decoder.getSymbolRejectCount();
+    result.counters[5] += decoder.getFrameCount();
+    result.has_counters = true;
+}
+
+// Times REPEAT runs of body(result) and keeps the result of the last one
+Result timed(const Edges &edges, const std::function<void(Result &)> &body) {
+    Result result;
+    double best = 1e30;
+    for (uint32_t r = 0; r < REPEAT; r++) {
+        result = Result();
+        auto start = std::chrono::steady_clock::now();
+        body(result);
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, ns);
+    }
+    result.ns_per_edge = edges.empty() ? 0 : best / edges.size();
+    return result;
+}
+
+// handleInterrupt() on every edge. Make builds a configured decoder.
+template <class Decoder, class Make>
+Result perEdge(const Edges &edges, Make make, const bool counters) {
+    return timed(edges, [&](Result &result) {
+        Decoder decoder = make();
+        for (const auto &edge : edges) {
+            decoder.handleInterrupt(edge.level, edge.ticks);
+            if (decoder.available()) readFrame(decoder, edge.ticks, result);
+        }
+        if constexpr (requires { decoder.getFrameCount(); }) {
+            if (counters) addCounters(decoder, result);
+        }
+    });
+}
+
+template <class Decoder, class Make>
+Result batchEdges(const Edges &edges, Make make) {
+    return timed(edges, [&](Result &result) {
+        Decoder decoder = make();
+        size_t i = 0;
+        while (i < edges.size()) {
+            size_t chunk = std::min<size_t>(256, edges.size() - i);
+            uint16_t n = decoder.handleEdges(&edges[i], uint16_t(chunk));
+            i += n;
+            if (decoder.available()) readFrame(decoder, edges[i - 1].ticks, result);
+        }
+        addCounters(decoder, result);
+    });
+}
+
+template <class Decoder, class Make>
+Result batchDurations(const Edges &edges, Make make) {
+    std::vector<uint32_t> durations;
+    for (size_t i = 1; i < edges.size(); i++) durations.push_back(edges[i].ticks - edges[i - 1].ticks);
+
+    return timed(edges, [&](Result &result) {
+        Decoder decoder = make();
+        if (edges.empty()) return;
+        decoder.handleInterrupt(edges[0].level, edges[0].ticks);
+        bool level = edges[0].level;
+        uint32_t ticks = edges[0].ticks;
+        size_t i = 0;
+        while (i < durations.size()) {
+            size_t chunk = std::min<size_t>(256, durations.size() - i);
+            i += decoder.handleDurations(&durations[i], uint16_t(chunk), level, ticks);
+            if (decoder.available()) readFrame(decoder, ticks, result);
+        }
+        addCounters(decoder, result);
+    });
+}
+
+// Ring with its running timestamp set on the corpus time base
+template <uint8_t RING_BITS>
+struct SeededRing : public HT600PulseRing<RING_BITS> {
+    void seed(const uint32_t ticks) { this -> _ticks = ticks; }
+};
+
+// DMA ring as written by the RP2040 front-end, drained after random amounts of pulses
+template <class Decoder, class Make>
+Result pulseRing(const Edges &edges, Make make) {
+    return timed(edges, [&](Result &result) {
+        Decoder decoder = make();
+        static SeededRing<8> ring;
+        ring = SeededRing<8>();
+        std::mt19937 rng(1);
+
+        // The PIO starts with a LOW pulse: the edges up to the first falling one go straight to the decoder
+        size_t first = 0;
+        while (first < edges.size()) {
+            decoder.handleInterrupt(edges[first].level, edges[first].ticks);
+            if (decoder.available()) readFrame(decoder, edges[first].ticks, result);
+            if (!edges[first++].level) break;
+        }
+        if (first == 0 || first >= edges.size()) return;
+        ring.seed(edges[first - 1].ticks);
+
+        uint32_t written = 0;
+        size_t i = first, consumed = 0;
+        while (i < edges.size()) {
+            for (uint32_t n = 1 + rng() % 64; n > 0 && i < edges.size(); n--, i++) {
+                ring.buffer()[written++ & (HT600PulseRing<8>::SIZE - 1)] = edges[i].ticks - edges[i - 1].ticks;
+            }
+            while (true) {
+                consumed += ring.drain(decoder, written);
+                if (!decoder.available()) break;
+                readFrame(decoder, edges[first - 1 + consumed].ticks, result);
+            }
+        }
+        addCounters(decoder, result);
+    });
+}
+
+// PIO RX FIFO (joined: 8 words) and DMA channel, the Dma parameter of HT600DmaCapture. Runs of 64
+// transfers into a 64-word ring, so that the ring wraps and the count runs out between two polls.
+class DmaModel {
+    public:
+        static const uint32_t MAX_COUNT = 64;
+
+        uint32_t remaining() const { return _count; }
+        bool busy() const { return _busy; }
+        void abort() {
+            _busy = false;
+            if (while_stopped) while_stopped();
+        }
+        void start(uint32_t *write, const uint8_t ring_bits, const uint32_t count) {
+            if (_fifo_count > 0) rearms_with_fifo++;
+            _write = write;
+            _ring_mask = (uintptr_t(4) << ring_bits) - 1;
+            _count = count;
+            _busy = count > 0;
+            transfer();
+        }
+
+        // push noblock: the word is lost if the FIFO is full
+        void push(const uint32_t word) {
+            if (_fifo_count == 8) {
+                lost++;
+                return;
+            }
+            _fifo[(_fifo_first + _fifo_count++) & 7] = word;
+            transfer();
+        }
+
+        std::function<void()> while_stopped; // PIO pushes between abort() and the next start()
+        uint32_t lost = 0;             // Words dropped by the PIO (FIFO full)
+        uint32_t exhausted = 0;        // Runs that reached a count of 0
+        uint32_t rearms_with_fifo = 0; // Runs started with words waiting in the FIFO
+
+    private:
+        // DREQ: one transfer per word in the FIFO while the run lasts
+        void transfer() {
+            while (_busy && _fifo_count > 0) {
+                *_write = _fifo[_fifo_first++ & 7];
+                _fifo_count--;
+                // Ring mode: the low bits of the address wrap, the high bits stay
+                uintptr_t address = reinterpret_cast<uintptr_t>(_write);
+                _write = reinterpret_cast<uint32_t *>((address & ~_ring_mask) | ((address + 4) & _ring_mask));
+                if (--_count == 0) {
+                    _busy = false;
+                    exhausted++;
+                }
+            }
+        }
+
+        uint32_t _fifo[8];
+        uint32_t _fifo_first = 0, _fifo_count = 0;
+        uint32_t *_write = nullptr;
+        uintptr_t _ring_mask = 0;
+        uint32_t _count = 0;
+        bool _busy = false;
+};
+
+struct SeededCapture : public HT600DmaCapture<DmaModel, SeededRing<6>> {
+    void seed(const uint32_t ticks) { _ring.seed(ticks); }
+};
+
+// Pushes 1 to 36 pulses between two polls, sometimes polls in the middle of them, and pushes up to
+// 3 more while a re-arm has the channel stopped (a burst going on). A run has 32 transfers left at
+// worst after a poll, the FIFO holds the rest: nothing may be lost. read(consumed) is called for each frame.
+template <class Decoder, class Read>
+void feedDma(SeededCapture &capture, DmaModel &dma, Decoder &decoder, const uint32_t *pulses, const size_t count, Read read) {
+    std::mt19937 rng(1);
+    size_t consumed = 0, i = 0;
+    dma.while_stopped = [&] {
+        for (uint32_t n = rng() % 4; n > 0 && i < count; n--) dma.push(pulses[i++]);
+    };
+    auto poll = [&] {
+        while (true) {
+            consumed += capture.poll(decoder, dma);
+            if (!decoder.available()) break;
+            read(consumed);
+        }
+    };
+
+    capture.start(dma);
+    while (i < count) {
+        for (uint32_t n = 1 + rng() % 36; n > 0 && i < count; n--) {
+            dma.push(pulses[i++]);
+            if (rng() % 16 == 0) poll();
+        }
+        poll();
+    }
+    dma.while_stopped = nullptr;
+}
+
+// HT600DmaCapture over the DMA model, same start as pulseRing()
+template <class Decoder, class Make>
+Result dmaCapture(const Edges &edges, Make make) {
+    std::vector<uint32_t> pulses;
+    for (size_t i = 1; i < edges.size(); i++) pulses.push_back(edges[i].ticks - edges[i - 1].ticks);
+
+    return timed(edges, [&](Result &result) {
+        Decoder decoder = make();
+        SeededCapture capture;
+        DmaModel dma;
+
+        size_t first = 0;
+        while (first < edges.size()) {
+            decoder.handleInterrupt(edges[first].level, edges[first].ticks);
+            if (decoder.available()) readFrame(decoder, edges[first].ticks, result);
+            if (!edges[first++].level) break;
+        }
+        if (first == 0 || first >= edges.size()) return;
+        capture.seed(edges[first - 1].ticks);
+
+        feedDma(capture, dma, decoder, &pulses[first - 1], pulses.size() - (first - 1), [&](const size_t consumed) {
+            // Bounded: a faulty capture may hand over more pulses than were pushed
+            readFrame(decoder, edges[std::min(first - 1 + consumed, edges.size() - 1)].ticks, result);
+        });
+        addCounters(decoder, result);
+    });
+}
+
+// Suspends after every chunk and resumes in the other decoder (counters of both are added)
+template <class Decoder, class Make>
+Result checkpointed(const Edges &edges, Make make) {
+    return timed(edges, [&](Result &result) {
+        Decoder decoders[2] = {make(), make()};
+        int current = 0;
+        size_t i = 0;
+        while (i < edges.size()) {
+            size_t end = std::min(edges.size(), i + 97);
+            while (i < end) {
+                i += decoders[current].handleEdges(&edges[i], uint16_t(end - i));
+                if (decoders[current].available()) readFrame(decoders[current], edges[i - 1].ticks, result);
+            }
+            HT600Checkpoint checkpoint = decoders[current].checkpoint();
+            current ^= 1;
+            decoders[current].restore(checkpoint);
+        }
+        addCounters(decoders[0], result);
+        addCounters(decoders[1], result);
+    });
+}
+
+// Frame found by a chunk decoder, with the index of the edge that completed it
+struct IndexedFrame {
+    size_t edge;
+    HT600Frame frame;
+};
+
+template <class Decoder>
+void feedEdge(Decoder &decoder, const Edges &edges, const size_t i, std::vector<IndexedFrame> &frames) {
+    decoder.handleInterrupt(edges[i].level, edges[i].ticks);
+    if (!decoder.available()) return;
+    frames.push_back({i, {edges[i].ticks, decoder.getReceivedValue(0), decoder.getTristateValue(1)}});
+    decoder.releaseFrame();
+}
+
+// Chunks of 1000 edges decoded from reset decoders (the parallel part), then stitched in order: the end
+// state of chunk k is restored and chunk k+1 replayed next to a reset decoder until both are in the same
+// state. The frames before that edge come from the replay, the ones after it from the parallel decode.
+template <class Decoder, class Make>
+Result stitched(const Edges &edges, Make make) {
+    const size_t CHUNK = 1000;
+    return timed(edges, [&](Result &result) {
+        size_t chunks = (edges.size() + CHUNK - 1) / CHUNK;
+        std::vector<std::vector<IndexedFrame>> frames(chunks);
+        std::vector<HT600Checkpoint> ends(chunks);
+        for (size_t k = 0; k < chunks; k++) {
+            Decoder decoder = make();
+            for (size_t i = k * CHUNK; i < std::min(edges.size(), (k + 1) * CHUNK); i++) feedEdge(decoder, edges, i, frames[k]);
+            ends[k] = decoder.checkpoint();
+        }
+
+        std::vector<IndexedFrame> merged = frames.empty() ? std::vector<IndexedFrame>() : frames[0];
+        HT600Checkpoint state = chunks ? ends[0] : HT600Checkpoint();
+        for (size_t k = 1; k < chunks; k++) {
+            Decoder replay = make(), reset = make();
+            replay.restore(state);
+            std::vector<IndexedFrame> ignored;
+            size_t i = k * CHUNK, end = std::min(edges.size(), (k + 1) * CHUNK);
+            bool converged = false;
+            while (i < end && !converged) {
+                feedEdge(replay, edges, i, merged);
+                feedEdge(reset, edges, i++, ignored);
+                converged = HT600_sameState(replay.checkpoint(), reset.checkpoint());
+            }
+            for (const auto &frame : frames[k]) if (frame.edge >= i) merged.push_back(frame);
+            state = converged ? ends[k] : replay.checkpoint();
+        }
+        for (const auto &frame : merged) result.frames.push_back(frame.frame);
+    });
+}
+
+template <class Decoder, class Make>
+Result ranges(const Edges &edges, Make make) {
+    return timed(edges, [&](Result &result) {
+        for (HT600Frame frame : edges | ht600::decode(make())) result.frames.push_back(frame);
+    });
+}
+
+template <uint16_t FOSC>
+std::vector<Implementation> implementations() {
+    typedef HT600Decoder<HT600RuntimeTiming, HT600TrinaryOutput, HT600Stats> Runtime;
+    typedef HT600Decoder<HT600FixedTiming<FOSC>, HT600TrinaryOutput, HT600Stats, HT600FixedFilter<NOISE_US>> Fixed;
+    typedef HT600Decoder<HT600FixedTiming<FOSC>, HT600PackedOutput, HT600Stats, HT600FixedFilter<NOISE_US>> Packed;
+    typedef HT600Decoder<HT600FixedTiming<FOSC>, HT600PackedOutput, HT600Stats, HT600FixedFilter<NOISE_US>, HT600CompactState> Compact;
+    typedef HT600Decoder<HT600ClockTiming<HT600TickClock<1>>, HT600TrinaryOutput, HT600Stats> Clock;
+
+    auto runtime = [] { return Runtime(FOSC, TOLERANCE, 1, NOISE_US); };
+    auto fixed = [] { return Fixed(); };
+    auto packed = [] { return Packed(); };
+    auto compact = [] { return Compact(); };
+    auto clock = [] { return Clock(FOSC, TOLERANCE, NOISE_US); };
+    auto plain = [] { return HT600(FOSC, TOLERANCE, 1, NOISE_US); };
+
+    return {
+        // The first one is the reference
+        {"HT600 handleInterrupt + HT600Stats",   ANY,         [=](const Edges &e) { return perEdge<Runtime>(e, runtime, true); }},
+        {"HT600 handleInterrupt (no stats)",     ANY,         [=](const Edges &e) { return perEdge<HT600>(e, plain, false); }},
+        {"FixedTiming + FixedFilter",            ANY,         [=](const Edges &e) { return perEdge<Fixed>(e, fixed, true); }},
+        {"FixedTiming + PackedOutput",           ANY,         [=](const Edges &e) { return perEdge<Packed>(e, packed, true); }},
+        {"FixedTiming + Packed + CompactState",  SHORT_GAPS,  [=](const Edges &e) { return perEdge<Compact>(e, compact, true); }},
+        {"ClockTiming<TickClock<1>>",            ANY,         [=](const Edges &e) { return perEdge<Clock>(e, clock, true); }},
+        {"handleEdges (batch of 256)",           ANY,         [=](const Edges &e) { return batchEdges<Runtime>(e, runtime); }},
+        {"handleDurations (batch of 256)",       ALTERNATING, [=](const Edges &e) { return batchDurations<Runtime>(e, runtime); }},
+        {"HT600PulseRing (RP2040 PIO path)",     ALTERNATING, [=](const Edges &e) { return pulseRing<Fixed>(e, fixed); }},
+        {"HT600DmaCapture (FIFO + DMA model)",   ALTERNATING, [=](const Edges &e) { return dmaCapture<Fixed>(e, fixed); }},
+        {"checkpoint/restore every 97 edges",    ANY,         [=](const Edges &e) { return checkpointed<Runtime>(e, runtime); }},
+        {"parallel chunks + stitch",             ANY,         [=](const Edges &e) { return stitched<Runtime>(e, runtime); }},
+        {"ht600::decode ranges view",            ANY,         [=](const Edges &e) { return ranges<HT600>(e, plain); }},
+    };
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// TIMING WINDOWS
+// ------------------------------------------------------------------------------------------------
+
+template <uint16_t... FOSC>
+struct FoscList {};
+
+typedef FoscList<HT680_120K_FOSC, HT680_150K_FOSC, HT680_180K_FOSC, HT680_220K_FOSC, HT680_270K_FOSC,
+                 HT680_330K_FOSC, HT680_390K_FOSC, HT680_470K_FOSC, HT680_560K_FOSC, HT680_680K_FOSC,
+                 HT680_820K_FOSC, HT680_1M0_FOSC, HT680_1M5_FOSC, HT680_2M0_FOSC> AllFosc;
+
+const uint16_t ALL_FOSC[] = {HT680_120K_FOSC, HT680_150K_FOSC, HT680_180K_FOSC, HT680_220K_FOSC, HT680_270K_FOSC,
+                             HT680_330K_FOSC, HT680_390K_FOSC, HT680_470K_FOSC, HT680_560K_FOSC, HT680_680K_FOSC,
+                             HT680_820K_FOSC, HT680_1M0_FOSC, HT680_1M5_FOSC, HT680_2M0_FOSC};
+
+// short, long and pilot windows (min, max) plus the prescaler shift
+struct Windows {
+    uint16_t bounds[6];
+    uint8_t shift;
+
+    bool operator==(const Windows &other) const {
+        return shift == other.shift && std::equal(bounds, bounds + 6, other.bounds);
+    }
+};
+
+template <class Timing>
+Windows windowsOf(const Timing &timing) {
+    return {{timing.shortMin(), timing.shortMax(), timing.longMin(), timing.longMax(), timing.pilotMin(), timing.pilotMax()},
+            timing.tickShift()};
+}
+
+// Failures of the timing checks (the first few are printed)
+struct TimingFailures {
+    uint32_t checked = 0;
+    uint32_t count = 0;
+
+    void check(const bool ok, const char *what, const uint16_t fosc, const double tolerance, const double tick_us) {
+        checked++;
+        if (ok) return;
+        if (count++ < 10) printf("   FAILED: %s (fosc %u, tolerance %.2f, tick %gus)\n", what, fosc, tolerance, tick_us);
+    }
+};
+
+// Windows ordered, and each bound within one prescaled tick below its nominal length
+// (a window computed without prescaling, or wrapped in 16 bits, is far off)
+bool windowsValid(const Windows &w, const uint16_t fosc, const double tolerance, const double tick_us) {
+    const double T = 33000.0 / fosc, unit = tick_us * double(1UL << w.shift);
+    const double nominal[6] = {T * (1 - tolerance), T * (1 + tolerance), 2 * T * (1 - tolerance), 2 * T * (1 + tolerance),
+                               36 * T * (1 - tolerance), 36 * T * (1 + tolerance)};
+    if (w.bounds[0] == 0) return false;
+    for (int i = 0; i < 6; i++) {
+        if (i > 0 && w.bounds[i] <= w.bounds[i - 1]) return false;
+        double error = nominal[i] - w.bounds[i] * unit;
+        if (error < -nominal[i] * 1e-5 || error > unit + nominal[i] * 1e-5) return false;
+    }
+    // The smallest shift that fits: one less would overflow the pilot window
+    return w.shift == 0 || 36 * T * (1 + tolerance) / (unit / 2) > 65535.0;
+}
+
+// HT600ClockTiming<Clock> against HT600RuntimeTiming with the tick length of the clock
+template <class Clock>
+void checkClockTiming(TimingFailures &failures, const uint16_t fosc, const float tolerance) {
+    HT600RuntimeTiming runtime;
+    runtime.configure(fosc, tolerance, Clock::tickLengthUs());
+    HT600ClockTiming<Clock> clock;
+    clock.configure(fosc, tolerance, Clock::tickLengthUs());
+
+    if (sizeof(typename Clock::tick_type) >= 4 || runtime.tickShift() == 0) {
+        failures.check(clock.isConfigured() && windowsOf(clock) == windowsOf(runtime),
+                       "HT600ClockTiming windows differ from HT600RuntimeTiming", fosc, tolerance, Clock::tickLengthUs());
+    } else {
+        // 16-bit clock that would need prescaling: refused, every window empty
+        Windows w = windowsOf(clock);
+        failures.check(!clock.isConfigured() && w.shift == 0 && w.bounds[0] > w.bounds[1] && w.bounds[2] > w.bounds[3] &&
+                       w.bounds[4] > w.bounds[5], "HT600ClockTiming accepts a prescaled 16-bit clock", fosc, tolerance, Clock::tickLengthUs());
+    }
+}
+
+// HT600FixedTiming must give the windows of HT600RuntimeTiming built with the same parameters
+template <uint8_t TOLERANCE_PCT, class Clock, uint16_t... FOSC>
+void checkFixedTiming(TimingFailures &failures, FoscList<FOSC...>) {
+    auto one = [&](const uint16_t fosc, const Windows &fixed) {
+        HT600RuntimeTiming runtime;
+        runtime.configure(fosc, float(TOLERANCE_PCT / 100.0), float(Clock::tickLengthUs()));
+        failures.check(fixed == windowsOf(runtime), "HT600FixedTiming windows differ from HT600RuntimeTiming",
+                       fosc, TOLERANCE_PCT / 100.0, Clock::tickLengthUs());
+    };
+    (one(FOSC, windowsOf(HT600FixedTiming<FOSC, TOLERANCE_PCT, Clock>())), ...);
+}
+
+// Pulse windows of the timing policies over the whole FOSC table
+bool checkTimings() {
+    printf("\n== timing windows: every HT680_*_FOSC, tolerance 5-30%%, ticks from 1ns to 4us\n");
+    const float tolerances[] = {0.05f, 0.10f, 0.15f, 0.20f, 0.25f, 0.30f};
+    const double ticks_us[] = {4, 2, 1, 0.5, 0.25, 0.1, 1 / 16.0, 1 / 80.0, 1 / 240.0, 0.001};
+
+    TimingFailures runtime;
+    for (uint16_t fosc : ALL_FOSC) {
+        for (float tolerance : tolerances) {
+            for (double tick_us : ticks_us) {
+                HT600RuntimeTiming timing;
+                timing.configure(fosc, tolerance, float(tick_us));
+                runtime.check(windowsValid(windowsOf(timing), fosc, tolerance, tick_us), "HT600RuntimeTiming windows", fosc, tolerance, tick_us);
+            }
+        }
+    }
+    printf("   %-40s  %s (%u configurations)\n", "HT600RuntimeTiming", runtime.count ? "WRONG WINDOWS" : "ok", runtime.checked);
+
+    TimingFailures clock;
+    for (uint16_t fosc : ALL_FOSC) {
+        for (float tolerance : tolerances) {
+            checkClockTiming<HT600TickClock<1>>(clock, fosc, tolerance);
+            checkClockTiming<HT600CounterClock<2000000UL>>(clock, fosc, tolerance);
+            checkClockTiming<HT600CounterClock<240000000UL>>(clock, fosc, tolerance);
+            checkClockTiming<HT600CounterClock<1000000000UL>>(clock, fosc, tolerance);
+            checkClockTiming<HT600CounterClock<2000000UL, uint16_t>>(clock, fosc, tolerance);
+            checkClockTiming<HT600CounterClock<250000UL, uint16_t>>(clock, fosc, tolerance);
+        }
+    }
+    printf("   %-40s  %s (%u configurations)\n", "HT600ClockTiming (16/32-bit clocks)", clock.count ? "WRONG WINDOWS" : "ok", clock.checked);
+
+    TimingFailures fixed;
+    checkFixedTiming<20, HT600TickClock<1>>(fixed, AllFosc());
+    checkFixedTiming<30, HT600TickClock<1>>(fixed, AllFosc());
+    checkFixedTiming<30, HT600CounterClock<2000000UL>>(fixed, AllFosc());
+    checkFixedTiming<30, HT600CounterClock<1000000000UL>>(fixed, AllFosc());
+    printf("   %-40s  %s (%u configurations)\n", "HT600FixedTiming = HT600RuntimeTiming", fixed.count ? "WINDOWS DIFFER" : "ok", fixed.checked);
+
+    // With 1us ticks the slowest oscillators are the ones whose pilot window exceeds 16 bits
+    bool prescaled = true;
+    for (uint16_t fosc : {HT680_1M0_FOSC, HT680_1M5_FOSC, HT680_2M0_FOSC}) {
+        HT600RuntimeTiming timing;
+        timing.configure(fosc, TOLERANCE, 1);
+        prescaled = prescaled && timing.tickShift() == (fosc == HT680_1M0_FOSC ? 0 : 1);
+        printf("   fosc=%-3u 1us ticks: shift %u, pilot %u..%u ticks\n", fosc, timing.tickShift(), timing.pilotMin(), timing.pilotMax());
+    }
+    printf("   %-40s  %s\n", "1M5 and 2M0 prescaled by 2, 1M0 not", prescaled ? "ok" : "WRONG SHIFT");
+
+    return !runtime.count && !clock.count && !fixed.count && prescaled;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// DMA CAPTURE
+// ------------------------------------------------------------------------------------------------
+
+// Decoder stand-in: records every pulse it is given, with its level, and never completes a frame
+struct PulseLog {
+    std::vector<uint32_t> pulses;
+    bool levels_ok = true;
+
+    uint16_t handleDurations(const uint32_t *durations, const uint16_t count, bool &level, uint32_t &ticks) {
+        for (uint16_t i = 0; i < count; i++) {
+            // The PIO starts on a LOW pulse: pulse n is HIGH if n is odd
+            if (level != bool(pulses.size() & 1)) levels_ok = false;
+            pulses.push_back(durations[i]);
+            ticks += durations[i];
+            level = !level;
+        }
+        return count;
+    }
+    bool available() const { return false; }
+    HT600_STATE getState() const { return HT600_STATE::IDLE; }
+    void resetAvailable() {}
+};
+
+// Every pulse pushed by the PIO reaches the decoder once, in order, through ring wraps, runs that
+// run out between two polls and re-arms while pulses wait in the FIFO
+bool checkDmaCapture() {
+    printf("\n== DMA capture: HT600DmaCapture over the PIO FIFO + DMA model (64-transfer runs, 64-word ring)\n");
+    std::vector<uint32_t> pulses(200000);
+    for (size_t i = 0; i < pulses.size(); i++) pulses[i] = uint32_t(i);
+
+    SeededCapture capture;
+    DmaModel dma;
+    PulseLog log;
+    feedDma(capture, dma, log, pulses.data(), pulses.size(), [](size_t) {});
+
+    bool exact = log.pulses == pulses && log.levels_ok && dma.lost == 0 && capture.getOverrunCount() == 0;
+    bool covered = pulses.size() / 64 > 2 && dma.exhausted > 0 && dma.rearms_with_fifo > 0;
+    printf("   %zu pulses, %zu ring wraps, %u runs ran out, %u re-arms with pulses in the FIFO\n",
+           pulses.size(), pulses.size() / 64, dma.exhausted, dma.rearms_with_fifo);
+    printf("   %-41s %s\n", "every pulse once, in order", exact ? "yes" : "NO, PULSES LOST OR DUPLICATED");
+    if (!covered) printf("   %-41s %s\n", "cases covered", "NO, CHANGE THE BURSTS");
+    return exact && covered;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// COMPARISON
+// ------------------------------------------------------------------------------------------------
+
+bool sameFrames(const Result &a, const Result &b) {
+    if (a.frames.size() != b.frames.size()) return false;
+    for (size_t i = 0; i < a.frames.size(); i++) {
+        if (a.frames[i].packed() != b.frames[i].packed() || a.frames[i].ticks != b.frames[i].ticks) return false;
+    }
+    return true;
+}
+
+template <uint16_t FOSC>
+bool check(const Corpus &corpus) {
+    const bool alternating = isAlternating(corpus.edges);
+    const bool short_gaps = maxGap(corpus.edges) <= (uint32_t(0xFFFF) << HT600FixedTiming<FOSC>::tickShift());
+
+    printf("\n== %s: %zu edges%s%s\n", corpus.name.c_str(), corpus.edges.size(),
+           alternating ? "" : ", levels not alternating", short_gaps ? "" : ", gaps above 16 bits");
+
+    auto list = implementations<FOSC>();
+    Result reference = list[0].run(corpus.edges);
+    printf("   %zu frames, counters glitch %u pilot %u timing %u sync %u symbol %u frame %u\n", reference.frames.size(),
+           reference.counters[0], reference.counters[1], reference.counters[2], reference.counters[3], reference.counters[4], reference.counters[5]);
+
+    bool ok = true;
+    if (corpus.wrap_offset) {
+        Corpus base = corpus;
+        for (auto &edge : base.edges) edge.ticks -= corpus.wrap_offset;
+        Result unwrapped = list[0].run(base.edges);
+        for (auto &frame : unwrapped.frames) frame.ticks += corpus.wrap_offset;
+        bool same = sameFrames(reference, unwrapped) && std::equal(reference.counters, reference.counters + 6, unwrapped.counters);
+        printf("   %-40s  %s\n", "same as without the wrap", same ? "yes" : "NO, FRAMES OR COUNTERS DIFFER");
+        ok = ok && same;
+    }
+    if (corpus.copies) {
+        bool all = reference.frames.size() == corpus.copies;
+        for (const auto &frame : reference.frames) all = all && frame.packed() == reference.frames[0].packed();
+        printf("   %-40s  %s\n", "every copy decoded", all ? "yes" : "NO, COPIES LOST");
+        ok = ok && all;
+    }
+    for (const auto &implementation : list) {
+        if (((implementation.needs & ALTERNATING) && !alternating) || ((implementation.needs & SHORT_GAPS) && !short_gaps)) {
+            printf("   %-40s  skipped (not applicable to this corpus)\n", implementation.name.c_str());
+            continue;
+        }
+        Result result = implementation.run(corpus.edges);
+        bool frames_ok = sameFrames(reference, result);
+        bool counters_ok = !result.has_counters || std::equal(result.counters, result.counters + 6, reference.counters);
+        printf("   %-40s  %s  %6.1f ns/edge  x%.2f\n", implementation.name.c_str(),
+               !frames_ok ? "FRAMES DIFFER  " : !counters_ok ? "COUNTERS DIFFER" : "identical      ",
+               result.ns_per_edge, result.ns_per_edge > 0 ? reference.ns_per_edge / result.ns_per_edge : 0.0);
+        ok = ok && frames_ok && counters_ok;
+    }
+    return ok;
+}
+
+bool dispatch(const Corpus &corpus) {
+    switch (corpus.fosc) {
+        case HT680_120K_FOSC: return check<HT680_120K_FOSC>(corpus);
+        case HT680_150K_FOSC: return check<HT680_150K_FOSC>(corpus);
+        case HT680_180K_FOSC: return check<HT680_180K_FOSC>(corpus);
+        case HT680_220K_FOSC: return check<HT680_220K_FOSC>(corpus);
+        case HT680_270K_FOSC: return check<HT680_270K_FOSC>(corpus);
+        case HT680_330K_FOSC: return check<HT680_330K_FOSC>(corpus);
+        case HT680_390K_FOSC: return check<HT680_390K_FOSC>(corpus);
+        case HT680_470K_FOSC: return check<HT680_470K_FOSC>(corpus);
+        case HT680_560K_FOSC: return check<HT680_560K_FOSC>(corpus);
+        case HT680_680K_FOSC: return check<HT680_680K_FOSC>(corpus);
+        case HT680_820K_FOSC: return check<HT680_820K_FOSC>(corpus);
+        case HT680_1M0_FOSC:  return check<HT680_1M0_FOSC>(corpus);
+        case HT680_1M5_FOSC:  return check<HT680_1M5_FOSC>(corpus);
+        case HT680_2M0_FOSC:  return check<HT680_2M0_FOSC>(corpus);
+    }
+    fprintf(stderr, "%s: fosc %u is not one of the HT680_*_FOSC values\n", corpus.name.c_str(), corpus.fosc);
+    return false;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    uint32_t seed = 1;
+    std::vector<Corpus> corpora;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-s" && i + 1 < argc) {
+            seed = uint32_t(atol(argv[++i]));
+        } else if (arg == "-f" && i + 2 < argc) {
+            uint16_t fosc = uint16_t(atoi(argv[++i]));
+            Corpus corpus;
+            if (!loadCapture(argv[++i], fosc, corpus)) {
+                fprintf(stderr, "Cannot open %s\n", argv[i]);
+                return 2;
+            }
+            corpora.push_back(corpus);
+        } else {
+            fprintf(stderr, "Usage: %s [-s seed] [-f fosc_khz capture.txt ...]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    for (uint16_t fosc : {HT680_120K_FOSC, HT680_330K_FOSC, HT680_390K_FOSC, HT680_1M5_FOSC}) {
+        corpora.push_back(synthetic(fosc, seed, 3000));
+    }
+    for (uint16_t fosc : {HT680_330K_FOSC, HT680_1M5_FOSC, HT680_2M0_FOSC}) {
+        corpora.push_back(wrapped(synthetic(fosc, seed, 3000)));
+    }
+    for (uint16_t fosc : {HT680_330K_FOSC, HT680_2M0_FOSC}) {
+        corpora.push_back(repeated(fosc, seed, 100));
+    }
+    corpora.push_back(fuzz(HT680_330K_FOSC, seed, 200000, true));
+    corpora.push_back(fuzz(HT680_330K_FOSC, seed + 1, 200000, false));
+
+    bool ok = checkTimings();
+    ok = checkDmaCapture() && ok;
+    for (const auto &corpus : corpora) ok = dispatch(corpus) && ok;
+
+    printf("\n%s\n", ok ? "All implementations are identical to the reference." : "MISMATCH: see above.");
+    return ok ? 0 : 1;
+}
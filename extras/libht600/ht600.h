@@ -0,0 +1,86 @@
+/**
+ * libht600: C ABI of the HT600 decoder, for host pipelines (Python ctypes/cffi, Go, Rust, Java...).
+ * * Each handle wraps the default decoder (HT600), so the frames are exactly the ones the library
+ * decodes on a microcontroller. Batch calls take caller-provided arrays and never allocate: only
+ * ht600_create() does. A handle must not be used by two threads at the same time; separate handles
+ * are independent.
+ *
+ * ABI: the structs below are fixed-size and never change within a major version (HT600_ABI_VERSION).
+ */
+
+#ifndef LIBHT600_H
+#define LIBHT600_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+  #define HT600_API __declspec(dllexport)
+#else
+  #define HT600_API __attribute__((visibility("default")))
+#endif
+
+#define HT600_ABI_VERSION 1
+
+typedef struct ht600_decoder ht600_decoder;
+
+// One transition of the input: timestamp (ticks) and level after the transition (0 LOW, any other value HIGH). 8 bytes.
+typedef struct {
+    uint32_t ticks;
+    uint8_t level;
+    uint8_t reserved[3];
+} ht600_edge;
+
+// A decoded frame: 16 data trits (Z read as 0), their Z mask, and the timestamp of the edge that completed it. 8 bytes.
+typedef struct {
+    uint32_t ticks;
+    uint16_t value;
+    uint16_t z_mask;
+} ht600_frame;
+
+// HT600_ABI_VERSION of the loaded library (compare with the header the caller was written against)
+HT600_API uint32_t ht600_abi_version(void);
+
+/**
+ * Same parameters as the HT600 constructor.
+ * fosc_khz: oscillator frequency of the encoder (HT680_*_FOSC values: 100 for a 330K resistor)
+ * tolerance: timing tolerance (0.3 = 30%)
+ * tick_length_us: length of a tick of the timestamps, in us
+ * noise_filter_us: pulses shorter than this are ignored
+ * Returns NULL if out of memory.
+ */
+HT600_API ht600_decoder *ht600_create(uint16_t fosc_khz, float tolerance, uint16_t tick_length_us, uint16_t noise_filter_us);
+HT600_API void ht600_destroy(ht600_decoder *decoder);
+
+// Back to the initial state (frame in progress dropped), e.g., between two unrelated logs
+HT600_API void ht600_reset(ht600_decoder *decoder);
+
+/**
+ * Decodes edges, writing the frames found into frames[0..capacity).
+ * Stops at the end of the edges or when 'capacity' frames are written: *consumed tells how many
+ * edges were used, call again with the rest. The decoder keeps its state between two calls, so a
+ * log can be fed in chunks of any size.
+ * Returns the number of frames written.
+ */
+HT600_API size_t ht600_decode_edges(ht600_decoder *decoder, const ht600_edge *edges, size_t count,
+                                    ht600_frame *frames, size_t capacity, size_t *consumed);
+
+/**
+ * Same with consecutive pulse lengths (ticks) of alternating level. The running timestamp and level
+ * are kept in the handle: set the level of the first pulse with ht600_set_level() (default: 1, HIGH).
+ */
+HT600_API size_t ht600_decode_durations(ht600_decoder *decoder, const uint32_t *durations, size_t count,
+                                        ht600_frame *frames, size_t capacity, size_t *consumed);
+
+// Level of the next pulse given to ht600_decode_durations() (0 or 1)
+HT600_API void ht600_set_level(ht600_decoder *decoder, int level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
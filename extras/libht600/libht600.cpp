@@ -0,0 +1,89 @@
+#include <new>
+#include <stddef.h>
+
+#include "HT600.h"
+#include "ht600.h"
+
+static_assert(sizeof(ht600_edge) == 8 && sizeof(ht600_frame) == 8, "ht600_edge/ht600_frame are part of the ABI");
+
+// ht600_edge is converted to HT600Edge on the stack, this many edges at a time (any non-zero level is HIGH)
+#define HT600_EDGE_CHUNK 256
+
+struct ht600_decoder {
+    ht600_decoder(const uint16_t fosc_khz, const float tolerance, const uint16_t tick_length_us, const uint16_t noise_filter_us)
+        : decoder(fosc_khz, tolerance, tick_length_us, noise_filter_us), initial(decoder), ticks(0), level(true) {}
+
+    HT600 decoder;
+    HT600 initial;   // Freshly constructed copy, for ht600_reset()
+    uint32_t ticks;  // Running timestamp of ht600_decode_durations()
+    bool level;      // Level of its next pulse
+};
+
+static void HT600_readFrame(ht600_decoder *d, const uint32_t ticks, ht600_frame &frame) {
+    frame.ticks = ticks;
+    frame.value = d -> decoder.getReceivedValue(0);
+    frame.z_mask = d -> decoder.getTristateValue(1);
+    d -> decoder.releaseFrame(); // Keeps the timestamp: the next copy of a held button is not lost
+}
+
+extern "C" {
+
+uint32_t ht600_abi_version(void) {
+    return HT600_ABI_VERSION;
+}
+
+ht600_decoder *ht600_create(uint16_t fosc_khz, float tolerance, uint16_t tick_length_us, uint16_t noise_filter_us) {
+    return new (std::nothrow) ht600_decoder(fosc_khz, tolerance, tick_length_us, noise_filter_us);
+}
+
+void ht600_destroy(ht600_decoder *decoder) {
+    delete decoder;
+}
+
+void ht600_reset(ht600_decoder *decoder) {
+    if (!decoder) return;
+    decoder -> decoder = decoder -> initial;
+    decoder -> ticks = 0;
+    decoder -> level = true;
+}
+
+void ht600_set_level(ht600_decoder *decoder, int level) {
+    if (decoder) decoder -> level = level != 0;
+}
+
+size_t ht600_decode_edges(ht600_decoder *decoder, const ht600_edge *edges, size_t count,
+                          ht600_frame *frames, size_t capacity, size_t *consumed) {
+    size_t i = 0, n = 0;
+    if (decoder && edges && (frames || !capacity)) {
+        HT600Edge input[HT600_EDGE_CHUNK];
+        while (i < count && n < capacity) {
+            size_t chunk = count - i;
+            if (chunk > HT600_EDGE_CHUNK) chunk = HT600_EDGE_CHUNK;
+            for (size_t k = 0; k < chunk; k++) {
+                input[k].ticks = edges[i + k].ticks;
+                input[k].level = edges[i + k].level != 0;
+            }
+            i += decoder -> decoder.handleEdges(input, uint16_t(chunk));
+            if (decoder -> decoder.available()) HT600_readFrame(decoder, edges[i - 1].ticks, frames[n++]);
+        }
+    }
+    if (consumed) *consumed = i;
+    return n;
+}
+
+size_t ht600_decode_durations(ht600_decoder *decoder, const uint32_t *durations, size_t count,
+                              ht600_frame *frames, size_t capacity, size_t *consumed) {
+    size_t i = 0, n = 0;
+    if (decoder && durations && (frames || !capacity)) {
+        while (i < count && n < capacity) {
+            size_t chunk = count - i;
+            if (chunk > 0xFFFF) chunk = 0xFFFF;
+            i += decoder -> decoder.handleDurations(durations + i, uint16_t(chunk), decoder -> level, decoder -> ticks);
+            if (decoder -> decoder.available()) HT600_readFrame(decoder, decoder -> ticks, frames[n++]);
+        }
+    }
+    if (consumed) *consumed = i;
+    return n;
+}
+
+}
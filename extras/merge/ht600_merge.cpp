@@ -0,0 +1,202 @@
+/**
+ * HT600 cross-gateway merge service (host)
+ * * Collapses the frames heard by several gateways into one event per button press (HT600FrameMerger).
+ *
+ * Build:  g++ -std=c++17 -O2 -I../../src ht600_merge.cpp -o ht600_merge
+ *
+ * Replay logs (one file per gateway, lines "<time_ms> <packed_hex>", '#' comments):
+ *   ./ht600_merge [-w window_ms] [-o gateway:offset_ms ...] gw0.log gw1.log gw2.log
+ *   The logs are merged in time order (each file must be sorted).
+ *
+ * Live (UDP datagrams "<gateway> <time_ms> <packed_hex>" on 127.0.0.1):
+ *   ./ht600_merge [-w window_ms] [-l lateness_ms] -u port
+ *   Frames are held for lateness_ms and released in time order, to absorb the network jitter.
+ *
+ * Output, one line per press: "<time_ms> <packed_hex> <first_gateway>".
+ * Statistics and throughput are printed on stderr at the end (end of logs, or Ctrl+C).
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "HT600Merge.h"
+
+namespace {
+
+struct Frame {
+    uint32_t time;
+    uint32_t packed;
+    uint8_t gateway;
+};
+
+// Earliest first (wrap-safe comparison)
+struct Later {
+    bool operator()(const Frame &a, const Frame &b) const { return int32_t(a.time - b.time) > 0; }
+};
+
+typedef std::priority_queue<Frame, std::vector<Frame>, Later> FrameQueue;
+
+volatile sig_atomic_t stop = 0;
+void onSignal(int) { stop = 1; }
+
+bool parseLog(const std::string &line, uint32_t &time, uint32_t &packed) {
+    if (line.empty() || line[0] == '#') return false;
+    std::istringstream in(line);
+    in >> time >> std::hex >> packed;
+    return bool(in);
+}
+
+bool parseDatagram(const char *text, Frame &frame) {
+    unsigned gateway;
+    if (sscanf(text, "%u %" SCNu32 " %" SCNx32, &gateway, &frame.time, &frame.packed) != 3) return false;
+    frame.gateway = uint8_t(gateway);
+    return true;
+}
+
+template <class Merger>
+void emit(Merger &merger, const Frame &frame) {
+    HT600Press press;
+    if (merger.push(frame.gateway, frame.time, frame.packed, press)) {
+        printf("%" PRIu32 " %08" PRIX32 " %u\n", press.time, press.packed, press.gateway);
+    }
+}
+
+// k-way merge of per-gateway logs
+template <class Merger>
+int replayLogs(Merger &merger, const std::vector<std::string> &paths) {
+    std::vector<std::ifstream> files;
+    FrameQueue queue;
+    std::string line;
+
+    auto next = [&](uint8_t gateway) {
+        uint32_t time, packed;
+        while (std::getline(files[gateway], line)) {
+            if (parseLog(line, time, packed)) {
+                queue.push({time, packed, gateway});
+                return;
+            }
+        }
+    };
+
+    for (size_t g = 0; g < paths.size(); g++) {
+        files.emplace_back(paths[g]);
+        if (!files.back()) {
+            fprintf(stderr, "Cannot open %s\n", paths[g].c_str());
+            return 1;
+        }
+    }
+    for (size_t g = 0; g < paths.size(); g++) next(uint8_t(g));
+
+    while (!queue.empty() && !stop) {
+        Frame frame = queue.top();
+        queue.pop();
+        emit(merger, frame);
+        next(frame.gateway);
+    }
+    return 0;
+}
+
+// Reorder buffer over UDP: a frame is released once a frame lateness_ms newer has arrived
+template <class Merger>
+int listenUdp(Merger &merger, const uint16_t port, const uint32_t lateness) {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (sock < 0 || bind(sock, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+        perror("bind");
+        return 1;
+    }
+
+    // Room for bursts from several gateways
+    int buffer_size = 4 << 20;
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+
+    FrameQueue queue;
+    uint32_t newest = 0;
+    bool any = false;
+    char buffer[128];
+
+    while (!stop) {
+        ssize_t n = recv(sock, buffer, sizeof(buffer) - 1, 0);
+        if (n <= 0) continue; // Interrupted
+        buffer[n] = '\0';
+
+        Frame frame;
+        if (!parseDatagram(buffer, frame)) continue;
+        if (!any || int32_t(frame.time - newest) > 0) newest = frame.time;
+        any = true;
+        queue.push(frame);
+
+        while (!queue.empty() && int32_t(newest - queue.top().time) >= int32_t(lateness)) {
+            emit(merger, queue.top());
+            queue.pop();
+        }
+        fflush(stdout);
+    }
+
+    while (!queue.empty()) {
+        emit(merger, queue.top());
+        queue.pop();
+    }
+    close(sock);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    uint32_t window = 200, lateness = 100;
+    int port = -1;
+    std::vector<std::string> paths;
+    std::vector<std::pair<int, int32_t>> offsets;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-w" && i + 1 < argc) window = uint32_t(atol(argv[++i]));
+        else if (arg == "-l" && i + 1 < argc) lateness = uint32_t(atol(argv[++i]));
+        else if (arg == "-u" && i + 1 < argc) port = atoi(argv[++i]);
+        else if (arg == "-o" && i + 1 < argc) {
+            int gateway;
+            long offset;
+            if (sscanf(argv[++i], "%d:%ld", &gateway, &offset) == 2) offsets.push_back({gateway, int32_t(offset)});
+        }
+        else paths.push_back(arg);
+    }
+    if ((port < 0) == paths.empty() || paths.size() > 32) {
+        fprintf(stderr, "Usage: %s [-w window_ms] [-o gateway:offset_ms] gw0.log gw1.log ...\n"
+                        "       %s [-w window_ms] [-l lateness_ms] -u port\n", argv[0], argv[0]);
+        return 2;
+    }
+
+    // No SA_RESTART: Ctrl+C must interrupt recv()
+    struct sigaction action = {};
+    action.sa_handler = onSignal;
+    sigaction(SIGINT, &action, nullptr);
+    static HT600FrameMerger<12> merger(window); // 4096 open presses
+    for (auto &o : offsets) merger.setOffset(uint8_t(o.first), o.second);
+
+    auto start = std::chrono::steady_clock::now();
+    int result = (port >= 0) ? listenUdp(merger, uint16_t(port), lateness) : replayLogs(merger, paths);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    fprintf(stderr, "frames %" PRIu32 ", presses %" PRIu32 ", duplicates %" PRIu32 ", evictions %" PRIu32 ", %.0f frames/s\n",
+            merger.getFrameCount(), merger.getPressCount(), merger.getDuplicateCount(), merger.getEvictionCount(),
+            seconds > 0 ? merger.getFrameCount() / seconds : 0.0);
+    return result;
+}
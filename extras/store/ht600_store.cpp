@@ -0,0 +1,105 @@
+/**
+ * HT600 frame history tool (host)
+ * * Imports decoded frames into an HT600Store file and answers time/address queries on it.
+ *
+ * Build:  g++ -std=c++17 -O2 -I../../src ht600_store.cpp -o ht600_store
+ *
+ * Import (stdin, e.g. the output of ht600_merge): lines "<time_ms> <packed_hex> [source] [confidence]"
+ *   ./ht600_store import history.ht600 [address_mask_hex] < frames.log
+ *   The address mask (HT600Frame::packed() layout) defaults to HT600_ADDRESS_MASK on both halves.
+ *
+ * Query: frames with from_ms <= time < to_ms, optionally of one address (any frame of the transmitter)
+ *   ./ht600_store query history.ht600 [-a packed_hex] [-f from_ms] [-t to_ms]
+ *   Output: "<time_ms> <packed_hex> <source> <confidence>"; blocks read and query time on stderr.
+ */
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "HT600.h"
+#include "HT600Store.h"
+
+namespace {
+
+int importFrames(const char *path, const uint32_t address_mask) {
+    HT600StoreWriter writer;
+    if (!writer.open(path, address_mask)) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return 1;
+    }
+
+    char line[256];
+    uint64_t count = 0;
+    while (fgets(line, sizeof(line), stdin)) {
+        if (line[0] == '#') continue;
+        int64_t time;
+        uint32_t packed;
+        unsigned source = 0, confidence = 0;
+        if (sscanf(line, "%" SCNd64 " %" SCNx32 " %u %u", &time, &packed, &source, &confidence) < 2) continue;
+        HT600Record record = {time, uint16_t(packed), uint16_t(packed >> 16), uint8_t(confidence), uint8_t(source)};
+        if (!writer.append(record)) {
+            fprintf(stderr, "Write error after %" PRIu64 " records\n", count);
+            return 1;
+        }
+        count++;
+    }
+    if (!writer.flush()) {
+        fprintf(stderr, "Write error\n");
+        return 1;
+    }
+    fprintf(stderr, "%" PRIu64 " records appended\n", count);
+    return 0;
+}
+
+int queryFrames(const char *path, const bool by_address, const uint32_t address, const int64_t from, const int64_t to) {
+    HT600StoreReader reader;
+    if (!reader.open(path)) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return 1;
+    }
+
+    auto print = [](const HT600Record &r) {
+        printf("%" PRId64 " %08" PRIX32 " %u %u\n", r.time_ms, r.packed(), r.source, r.confidence);
+    };
+    auto start = std::chrono::steady_clock::now();
+    uint64_t count = by_address ? reader.query(address, from, to, print) : reader.query(from, to, print);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    fprintf(stderr, "%" PRIu64 " records, %" PRIu64 " of %" PRIu64 " blocks read, %.2f ms\n",
+            count, reader.getBlocksRead(), reader.getBlockCount(), ms);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc >= 3 && strcmp(argv[1], "import") == 0) {
+        uint32_t mask = (uint32_t(HT600_ADDRESS_MASK) << 16) | HT600_ADDRESS_MASK;
+        if (argc >= 4) mask = uint32_t(strtoul(argv[3], nullptr, 16));
+        return importFrames(argv[2], mask);
+    }
+
+    if (argc >= 3 && strcmp(argv[1], "query") == 0) {
+        bool by_address = false;
+        uint32_t address = 0;
+        int64_t from = INT64_MIN, to = INT64_MAX;
+        for (int i = 3; i + 1 < argc; i += 2) {
+            std::string arg = argv[i];
+            if (arg == "-a") {
+                by_address = true;
+                address = uint32_t(strtoul(argv[i + 1], nullptr, 16));
+            }
+            else if (arg == "-f") from = strtoll(argv[i + 1], nullptr, 10);
+            else if (arg == "-t") to = strtoll(argv[i + 1], nullptr, 10);
+        }
+        return queryFrames(argv[2], by_address, address, from, to);
+    }
+
+    fprintf(stderr, "Usage: %s import store [address_mask_hex] < frames\n"
+                    "       %s query store [-a packed_hex] [-f from_ms] [-t to_ms]\n", argv[0], argv[0]);
+    return 2;
+}
@@ -36,6 +36,15 @@
 
 #define HT600_IS_IN_RANGE(val, min, max) (val >= min && val <= max)
 
+// Address and data trits of each chip in getReceivedValue() / getTristateValue() (bit 0 = A0).
+// The unbonded trits (always 'Z') belong to neither mask.
+#define HT600_ADDRESS_MASK  0x03DF // A0-A4, A6-A9
+#define HT600_DATA_MASK     0xF800 // AD11-AD15
+#define HT680_ADDRESS_MASK  0x03CF // A0-A3, A6-A9
+#define HT680_DATA_MASK     0xD800 // AD11, AD12, AD14, AD15
+#define HT6207_ADDRESS_MASK 0x0BDF // A0-A4, A6-A9, A11
+#define HT6207_DATA_MASK    0xF000 // D12-D15
+
 /**
  * @section HT680/318 SERIES
  * According to the datasheet, each word handles a total of 18 bits of information.
@@ -85,51 +94,358 @@
  * 'Symbol 1': ─┼───────┘   ├──
 */        
 
-enum class HT600_STATE {
+enum class HT600_STATE : uint8_t {
     IDLE,
     READING,
     DONE
 };
 
+#include "HT600Policies.h"
+
+// One transition of the input: timestamp and level after the transition (batch entry point)
+struct HT600Edge {
+    uint32_t ticks;
+    bool level;
+};
+
+// A decoded frame: the 16 data trits (Z read as 0), their Z mask, and the timestamp of the edge that completed it
+struct HT600Frame {
+    uint32_t ticks;
+    uint16_t value;
+    uint16_t z_mask;
+
+    // Whole frame as a single key: Z mask in the high half, value in the low half
+    uint32_t packed() const { return (uint32_t(z_mask) << 16) | value; }
+};
+
+// Header-only build: define HT600_HEADER_ONLY (e.g., -DHT600_HEADER_ONLY) to inline the whole decoder
+// into the user ISR. The ISR wrapper then runs without any call, register save/restore included.
+// Otherwise handleInterrupt is a regular function (in IRAM on ESP) compiled once in HT600.cpp.
+#if defined(HT600_HEADER_ONLY)
+  #define HT600_ISR_ATTR HT600_INLINE
+#else
+  #define HT600_ISR_ATTR IRAM_ATTR
+#endif
 
-class HT600 {
+/**
+ * @brief Policy-based HT600 decoder (see @section POLICIES in HT600Policies.h).
+ * HT600 is the default composition: runtime timing, trinary buffers, no stats, runtime noise filter, wide state.
+ *
+ * Example of a compile-time configuration for ATtiny: no thresholds in RAM, 4 bytes of output.
+ *   HT600Decoder<HT600FixedTiming<HT680_330K_FOSC>, HT600PackedOutput, HT600NoStats, HT600FixedFilter<50>> decoder;
+ */
+template <class TimingPolicy = HT600RuntimeTiming,
+          class OutputPolicy = HT600TrinaryOutput,
+          class StatsPolicy  = HT600NoStats,
+          class FilterPolicy = HT600RuntimeFilter,
+          class StatePolicy  = HT600WideState>
+class HT600Decoder : public TimingPolicy, public OutputPolicy, public StatsPolicy, public FilterPolicy, public StatePolicy {
     public:
-        HT600(const uint16_t fosc_khz, const float tolerance, const uint16_t tick_length_us, const uint16_t noise_filter_us);
-        const bool available() { return _state == HT600_STATE::DONE; } ;
-        const HT600_STATE getState() { return _state; };
-        uint16_t getReceivedValue(bool z_value = 0) const;
-        uint16_t getTristateValue (bool z_value = 1) const;
+        // For compile-time policies only (HT600FixedTiming, HT600FixedFilter/HT600NoFilter)
+        HT600Decoder() { this -> resetAvailable(); }
+        HT600Decoder(const uint16_t fosc_khz, const float tolerance, const uint16_t tick_length_us, const uint16_t noise_filter_us);
+        // For clock-based timing policies (HT600ClockTiming<Clock>): the tick length comes from the clock
+        template <class Timing = TimingPolicy>
+        HT600Decoder(const uint16_t fosc_khz, const float tolerance, const uint16_t noise_filter_us);
+        const bool available() { return this -> state() == HT600_STATE::DONE; } ;
+        const HT600_STATE getState() { return this -> state(); };
         void resetAvailable();
-        void IRAM_ATTR handleInterrupt(const bool pinState, const uint32_t ticks);
+        void releaseFrame();
+        void HT600_ISR_ATTR handleInterrupt(const bool pinState, const uint32_t ticks);
+
+        // Batch entry points: timestamped edges (captures, files), or pulse lengths measured by hardware (e.g., RP2040 PIO, see HT600Pio.h)
+        uint16_t handleEdges(const HT600Edge *edges, const uint16_t count);
+        uint16_t handleDurations(const uint32_t *durations, const uint16_t count, bool &level, uint32_t &ticks);
+
+        // Suspend/resume between two chunks of input (see HT600Checkpoint)
+        HT600Checkpoint checkpoint() const;
+        void restore(const HT600Checkpoint &checkpoint);
+
+        // Same as handleInterrupt(), with the timestamp read from the clock of the timing policy
+        template <class Timing = TimingPolicy>
+        HT600_INLINE void handleEdge(const bool pinState) {
+            typedef typename Timing::clock_type Clock;
+            static_assert(sizeof(typename Clock::tick_type) >= sizeof(typename StatePolicy::tick_type),
+                          "HT600Decoder: 16-bit clocks require HT600CompactState");
+            handleInterrupt(pinState, Clock::now());
+        }
 
     private:
-        uint16_t _short_tick_min; 
-        uint16_t _short_tick_max;
-        uint16_t _long_tick_min;  
-        uint16_t _long_tick_max; 
-        uint16_t _pilot_tick_min;
-        uint16_t _pilot_tick_max;
-        uint16_t _noise_filter_tick;
-
-        HT600_STATE _state = HT600_STATE::IDLE;
-
-        // Since the HT600 is a ternary encoder, we can use 2 bits to represent the 3 possible states of each bit (0, 1, Z).
-        // Simplest way to do this is to use two different buffer, one to store if the bit is '1' and the other to store if the bit is 'Z'.
-        // Since we have 18 bits we need 3 bytes for each buffer
-        volatile uint8_t _buffer_HL [3]; // In this buffer we store the state of the 'H' and 'L' bits
-        volatile uint8_t _buffer_Z  [3]; // In this buffer we store the state of the 'Z' bit
-
-        volatile uint8_t _bit_index = 0; // Index of the current bit being read (0-17)
-        volatile bool _half_symbol_read = false; // Flag to indicate if we have read the first half of the symbol 
-        volatile bool _last_symbol = false;
-
-        volatile uint32_t _last_interrupt_tick = 0; // Last time the interrupt was called
-        volatile uint16_t _period_L = 0; // Duration of the last LOW period in ticks
-        volatile uint16_t _period_H = 0; // Duration of the last HIGH period in ticks
-        
-
-        
+        void reject(const HT600_REJECT reason);
 };
 
+typedef HT600Decoder<> HT600;
+
+/**
+ * @brief Smallest decoder: everything known at compile time, packed output and packed state.
+ * Ticks must come from a 1us source (e.g., micros()).
+ */
+template <uint16_t FOSC_KHZ, uint8_t TOLERANCE_PCT = 30, uint16_t NOISE_FILTER_US = 50>
+using HT600Compact = HT600Decoder<HT600FixedTiming<FOSC_KHZ, TOLERANCE_PCT>, HT600PackedOutput, HT600NoStats, HT600FixedFilter<NOISE_FILTER_US>, HT600CompactState>;
+
+// 4 bytes of trits + 5 bytes of state (+1 byte of padding on 16/32-bit targets)
+#if defined(__AVR__)
+static_assert(sizeof(HT600Compact<HT680_330K_FOSC>) <= 9, "HT600Compact must fit in 9 bytes of RAM on AVR");
+#else
+static_assert(sizeof(HT600Compact<HT680_330K_FOSC>) <= 10, "HT600Compact must fit in 10 bytes of RAM");
+#endif
+
+
+/**
+ * @brief Constructor for the HT680 decoder.
+ * * Calculations based on HT680 Datasheet (see HT600RuntimeTiming).
+ * * @param fosc_khz The oscillation frequency based on Rosc (use HT680_XXXK_FOSC macros).
+ * @param tolerance Percentage of error allowed (e.g., 0.3 for 30%) Avoid values greater than ~0.3 to avoid overlapping beetwen short and long pulses timing.
+ * @param tick_length_us The resolution of the timestamp source in microseconds (e.g., 1.0 for micros()).
+ * @param noise_filter_us Minimum duration between transitions to filter out noise (e.g., 50.0 for 50 microseconds).
+ */
+template <class TimingPolicy, class OutputPolicy, class StatsPolicy, class FilterPolicy, class StatePolicy>
+HT600Decoder<TimingPolicy, OutputPolicy, StatsPolicy, FilterPolicy, StatePolicy>::HT600Decoder(const uint16_t fosc_khz, const float tolerance, const uint16_t tick_length_us, const uint16_t noise_filter_us) {
+    TimingPolicy::configure(fosc_khz, tolerance, tick_length_us);
+    FilterPolicy::configure(noise_filter_us, tick_length_us * float(1UL << this -> tickShift()));
+
+    this -> resetAvailable();
+}
+
+/**
+ * @brief Constructor for clock-based timing policies.
+ * * @param fosc_khz The oscillation frequency based on Rosc (use HT680_XXXK_FOSC macros).
+ * @param tolerance Percentage of error allowed (e.g., 0.3 for 30%).
+ * @param noise_filter_us Minimum duration between transitions to filter out noise (e.g., 50 for 50 microseconds).
+ */
+template <class TimingPolicy, class OutputPolicy, class StatsPolicy, class FilterPolicy, class StatePolicy>
+template <class Timing>
+HT600Decoder<TimingPolicy, OutputPolicy, StatsPolicy, FilterPolicy, StatePolicy>::HT600Decoder(const uint16_t fosc_khz, const float tolerance, const uint16_t noise_filter_us) {
+    const float tick_length_us = Timing::clock_type::tickLengthUs();
+    TimingPolicy::configure(fosc_khz, tolerance, tick_length_us);
+    FilterPolicy::configure(noise_filter_us, tick_length_us * float(1UL << this -> tickShift()));
+
+    this -> resetAvailable();
+}
+
+/**
+ * @brief Event processor for the HT600 decoder logic.
+ * * This function must be called by an external ISR dispatcher. It calculates 
+ * the time delta between transitions to decode the trinary signal.
+ * * @param pinState The current logical state of the input pin (true/false).
+ * @param ticks The current timestamp in ticks (Resolution must match tick_length_us or the clock policy).
+ */
+template <class TimingPolicy, class OutputPolicy, class StatsPolicy, class FilterPolicy, class StatePolicy>
+void HT600Decoder<TimingPolicy, OutputPolicy, StatsPolicy, FilterPolicy, StatePolicy>::handleInterrupt(const bool pinState, const uint32_t ticks) {
+    this -> onEdge(pinState);
+
+    // If the state is DONE, wait until the results are handled by the main loop
+    if (this -> state() == HT600_STATE::DONE) return;
+
+    // Timing calculations (prescaled when the pilot window does not fit in 16 bits)
+    const uint8_t shift = this -> tickShift();
+    typename StatePolicy::tick_type delta = this -> elapsed(ticks, shift);
+    
+    // Ignore transitions that are too close together (de-glitch filter)
+    if (this -> isGlitch(delta, shift)) {
+        this -> onGlitch();
+        return;
+    }
+
+    this -> stamp(ticks, shift);
+
+    // If pinState is true (Rising Edge), store the duration of the preceding LOW period
+    if (pinState == true) {
+        this -> setPeriodL((delta > 0xFFFF) ? 0xFFFF : (uint16_t)delta);
+        return; // Logic continues on the next Falling Edge
+    }
+
+    // If pinState is false (Falling Edge), the delta is the duration of the preceding HIGH period
+    const uint16_t raw_period_L = this -> periodL();
+    const uint16_t raw_period_H = (delta > 0xFFFF) ? 0xFFFF : (uint16_t)delta;
+
+    // Receiver asymmetry compensation (no-op unless the filter policy provides it)
+    uint16_t period_L = raw_period_L;
+    uint16_t period_H = raw_period_H;
+    this -> correct(period_L, period_H);
+
+    // IDLE State: Looking for the Pilot signal (long LOW pulse) followed by the first SYNC pulse
+    if (this -> state() == HT600_STATE::IDLE) {
+        // A valid Pilot is a long LOW followed by a SHORT HIGH pulse
+        if (HT600_IS_IN_RANGE(period_L, this -> pilotMin(), this -> pilotMax()) && HT600_IS_IN_RANGE(period_H, this -> shortMin(), this -> shortMax())) {
+            this -> startFrame();
+            this -> restart();
+            this -> onPilot();
+        }
+        // Nothing else to do in IDLE state, just wait for the next transition
+        return;
+    }
+
+    // If current state is SYNC_1, SYNC_2 or READING, decode the symbols
+    bool current_symbol = 0;
+    if (HT600_IS_IN_RANGE(period_L, this -> shortMin(), this -> shortMax()) && HT600_IS_IN_RANGE(period_H, this -> longMin(), this -> longMax())) {
+        current_symbol = 0;
+    }
+    else if (HT600_IS_IN_RANGE(period_L, this -> longMin(), this -> longMax()) && HT600_IS_IN_RANGE(period_H, this -> shortMin(), this -> shortMax())) {
+        current_symbol = 1;
+    }
+    else if (HT600_IS_IN_RANGE(period_L, this -> pilotMin(), this -> pilotMax()) && HT600_IS_IN_RANGE(period_H, this -> shortMin(), this -> shortMax())) {
+        // This is a special case where we might have a new pilot signal in the middle of reading, maybe due to noise or a new transmission starting.
+        // Set the state to SYNC_1 and wait for the next transition
+        this -> startFrame();
+        this -> restart();
+        this -> onPilot();
+        return;
+    }
+    else {
+        // Bad timing, reset to IDLE and wait for the next transition
+        this -> reject(HT600_REJECT::TIMING);
+        return;
+    }
+
+    this -> learn(raw_period_L, raw_period_H, current_symbol);
+
+    if (!this -> halfSymbolRead()) {
+        // If we are reading the first half of the symbol, store the current symbol and wait for the next transition
+        this -> setHalfSymbol(current_symbol);
+        return;
+    }
+    
+    // If we are reading the second half of the symbol, we can decode the bit
+    bool last_symbol = this -> lastSymbol();
+    uint8_t bit_index = this -> bitIndex();
+    this -> clearHalfSymbol();
+
+    // Bit 0 & 1: SYNC Pattern validation (Must be SYMBOL1 + SYMBOL0)
+    if (bit_index < 2) { 
+        if (last_symbol == 0 && current_symbol == 1) {
+            this -> nextBit(); // Sync bit valid, proceed
+            return; 
+        } else {
+            this -> reject(HT600_REJECT::SYNC);
+            return;
+        }
+    }
+
+    // --- DATA BITS DECODING (Bit 2 to 19) ---
+    if (last_symbol == 0 && current_symbol == 0) {
+        // Logical '0': SYMBOL0 + SYMBOL0
+        this -> storeTrit(bit_index, false, false);
+    }
+    else if (last_symbol == 1 && current_symbol == 1) {
+        // Logical '1': SYMBOL1 + SYMBOL1
+        this -> storeTrit(bit_index, true, false);
+    }
+    else if (last_symbol == 1 && current_symbol == 0) {
+        // Logical 'Z': SYMBOL1 + SYMBOL0
+        this -> storeTrit(bit_index, false, true);
+    }
+    else {
+        this -> reject(HT600_REJECT::SYMBOL);
+        return;
+    }
+
+    this -> nextBit(); 
+    // 2 Sync bits + 18 Data bits = 20 total bits
+    if (bit_index + 1 >= 20) {
+        this -> setDone();
+        this -> onFrame();
+    }
+}
+
+/**
+ * @brief Feeds the decoder with a chunk of edges, same as calling handleInterrupt() on each one.
+ * Stops right after the edge that completes a frame (and does nothing while a frame is available):
+ * read it, call releaseFrame() and call again with the remaining edges.
+ * The decoder keeps its state between two calls, so a frame can span two chunks.
+ * @return The number of edges consumed.
+ */
+template <class TimingPolicy, class OutputPolicy, class StatsPolicy, class FilterPolicy, class StatePolicy>
+uint16_t HT600Decoder<TimingPolicy, OutputPolicy, StatsPolicy, FilterPolicy, StatePolicy>::handleEdges(const HT600Edge *edges, const uint16_t count) {
+    uint16_t i = 0;
+    while (i < count && this -> state() != HT600_STATE::DONE) {
+        this -> handleInterrupt(edges[i].level, edges[i].ticks);
+        i++;
+    }
+    return i;
+}
+
+/**
+ * @brief Feeds the decoder with consecutive pulse lengths of alternating level.
+ * * Each pulse is turned into the edge that ends it, with a running timestamp, so the result is
+ * exactly the same as calling handleInterrupt() on every edge. Stops right after the pulse that
+ * completes a frame (and does nothing while a frame is available): read it, call releaseFrame()
+ * and call again with the remaining pulses.
+ * * @param durations Pulse lengths in ticks.
+ * @param count Number of pulses.
+ * @param level In: level of durations[0]. Out: level of the next pulse.
+ * @param ticks In/Out: running timestamp, the end of the last pulse fed.
+ * @return The number of pulses consumed.
+ */
+template <class TimingPolicy, class OutputPolicy, class StatsPolicy, class FilterPolicy, class StatePolicy>
+uint16_t HT600Decoder<TimingPolicy, OutputPolicy, StatsPolicy, FilterPolicy, StatePolicy>::handleDurations(const uint32_t *durations, const uint16_t count, bool &level, uint32_t &ticks) {
+    uint16_t i = 0;
+    while (i < count && this -> state() != HT600_STATE::DONE) {
+        ticks += durations[i++];
+        // The pulse at 'level' ends with a transition to the opposite level
+        level = !level;
+        this -> handleInterrupt(level, ticks);
+    }
+    return i;
+}
+
+/**
+ * @brief Copies the decoder state (FSM, partial trits, last tick, partial period, filter estimate).
+ * * Resuming a chunked input: checkpoint() after the last edge of a chunk, restore() into the decoder
+ * that gets the next chunk (another instance, another thread, after a reboot...).
+ * * Stitching chunks decoded in parallel: each chunk is decoded from a reset decoder, which misses the
+ * frames across its start. Then, in order, the end state of chunk k is restored into a decoder that
+ * replays chunk k+1 next to a reset decoder, until HT600_sameState() holds for both checkpoints: the
+ * frames before that edge come from the replay, the ones after it from the parallel decode. The end
+ * state of chunk k+1 is the one of its parallel decode, or of the replay if it never converged.
+ * On 8-bit MCUs call it with interrupts disabled, or while the decoder is not fed.
+ */
+template <class TimingPolicy, class OutputPolicy, class StatsPolicy, class FilterPolicy, class StatePolicy>
+HT600Checkpoint HT600Decoder<TimingPolicy, OutputPolicy, StatsPolicy, FilterPolicy, StatePolicy>::checkpoint() const {
+    HT600Checkpoint checkpoint;
+    OutputPolicy::save(checkpoint);
+    FilterPolicy::save(checkpoint);
+    StatePolicy::save(checkpoint);
+    return checkpoint;
+}
+
+template <class TimingPolicy, class OutputPolicy, class StatsPolicy, class FilterPolicy, class StatePolicy>
+void HT600Decoder<TimingPolicy, OutputPolicy, StatsPolicy, FilterPolicy, StatePolicy>::restore(const HT600Checkpoint &checkpoint) {
+    OutputPolicy::restore(checkpoint);
+    FilterPolicy::restore(checkpoint);
+    StatePolicy::restore(checkpoint);
+}
+
+template <class TimingPolicy, class OutputPolicy, class StatsPolicy, class FilterPolicy, class StatePolicy>
+void HT600Decoder<TimingPolicy, OutputPolicy, StatsPolicy, FilterPolicy, StatePolicy>::resetAvailable() {
+    this -> clear();
+}
 
-#endif
\ No newline at end of file
+/**
+ * @brief Same as resetAvailable(), but keeps the timestamp of the last transition.
+ * * A held button sends its frame back-to-back: the pilot of the next copy ends with the first edge
+ * after the frame just read. resetAvailable() forgets the timestamp that pilot is measured from, so
+ * that copy is lost; releaseFrame() keeps it. Use it after handleEdges() and handleDurations(), which
+ * stop right after the frame. From an ISR it recovers the next copy when the frame is read before its
+ * pilot ends (edges are dropped while a frame is available).
+ */
+template <class TimingPolicy, class OutputPolicy, class StatsPolicy, class FilterPolicy, class StatePolicy>
+void HT600Decoder<TimingPolicy, OutputPolicy, StatsPolicy, FilterPolicy, StatePolicy>::releaseFrame() {
+    this -> release();
+}
+
+// Notifies the stats policy, then resets to IDLE and waits for the next transition
+template <class TimingPolicy, class OutputPolicy, class StatsPolicy, class FilterPolicy, class StatePolicy>
+HT600_INLINE void HT600Decoder<TimingPolicy, OutputPolicy, StatsPolicy, FilterPolicy, StatePolicy>::reject(const HT600_REJECT reason) {
+    this -> onReject(reason, this -> bitIndex());
+    this -> onPartialFrame(static_cast<const OutputPolicy &>(*this), this -> bitIndex());
+    this -> clear(); // Same as resetAvailable(), always inlined
+}
+
+// The default composition is compiled once in HT600.cpp
+#if !defined(HT600_HEADER_ONLY)
+extern template class HT600Decoder<>;
+#endif
+
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef HT600_BUTTONS_H
+#define HT600_BUTTONS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @section BUTTONS
+ * Each data trit of a remote is a button (data pins of HT600/HT680, keys of HT6207): the tracker keeps
+ * the buttons held by each transmitter address and turns the decoded frames into press/release events,
+ * so that a multi-button remote drives actions without diffing getReceivedValue() in loop().
+ *
+ * A button is held while its data trit is '1' in the frames of its address (a 'Z' or '0' data trit is
+ * not pressed). A frame reports the buttons that went down and up since the previous frame of the same
+ * address. The encoder only transmits while a button is held, so the release of the last buttons is
+ * reported by poll() once the address has been silent for 'timeout_ms'.
+ *
+ * The table is a fixed array of 2^SLOT_BITS addresses indexed by a hash of the address, with at most
+ * PROBES slots visited per frame (same layout as HT600RateLimiter). An address only takes a slot while
+ * it holds a button; when the probed slots are all taken, the least recently seen address is recycled
+ * and its held buttons are forgotten (getEvictionCount()).
+ */
+
+struct HT600ButtonEvent {
+    uint32_t address;  // The frame with its data trits cleared (HT600Frame::packed() layout)
+    uint16_t pressed;  // Data bits that went down with this frame
+    uint16_t released; // Data bits that went up
+    uint16_t held;     // Data bits held after this event
+};
+
+/**
+ * @brief Per-address button state in a fixed hash table.
+ * @tparam SLOT_BITS 2^SLOT_BITS addresses holding buttons at once (16 bytes each).
+ * @tparam PROBES Slots visited per frame before recycling one.
+ */
+template <uint8_t SLOT_BITS = 2, uint8_t PROBES = 4>
+class HT600ButtonTracker {
+    public:
+        /**
+         * @param data_mask Data trits of the chip (e.g., HT6207_DATA_MASK): the buttons. The other trits are the address.
+         * @param timeout_ms Silence after which the held buttons of an address are released: longer than
+         * the encoder repeat interval (e.g., 150ms for a 330K resistor; frames can be missed).
+         */
+        HT600ButtonTracker(const uint16_t data_mask, const uint16_t timeout_ms)
+            : _data_mask(data_mask), _timeout_ms(timeout_ms) {
+            clear();
+        }
+
+        /**
+         * @brief Updates the buttons of the frame's address.
+         * @param packed The whole frame: (getTristateValue(1) << 16) | getReceivedValue(0) or HT600Frame::packed().
+         * @param now_ms Current time (e.g., millis()), wrapping around is fine.
+         * @param event Out: the changes of this address.
+         * @return true if a button went down or up (event.pressed or event.released not 0).
+         */
+        bool update(const uint32_t packed, const uint32_t now_ms, HT600ButtonEvent &event) {
+            uint32_t data_bits = (uint32_t(_data_mask) << 16) | _data_mask;
+            uint16_t buttons = uint16_t(packed) & _data_mask & ~uint16_t(packed >> 16);
+
+            event.address = packed & ~data_bits;
+            Slot *slot = find(event.address, now_ms, buttons != 0);
+            uint16_t previous = slot ? slot -> held : 0;
+
+            event.pressed = buttons & ~previous;
+            event.released = previous & ~buttons;
+            event.held = buttons;
+
+            if (slot) {
+                slot -> held = buttons;
+                slot -> seen_ms = now_ms;
+                slot -> used = buttons != 0; // Nothing held: nothing to track
+            }
+            return event.pressed || event.released;
+        }
+
+        /**
+         * @brief Releases the buttons of an address silent for timeout_ms. Call it from loop(), until it returns false.
+         * @return true if an event was written (event.released = the buttons that were held).
+         */
+        bool poll(const uint32_t now_ms, HT600ButtonEvent &event) {
+            for (uint16_t i = 0; i < SLOTS; i++) {
+                Slot &slot = _slots[i];
+                if (!slot.used || now_ms - slot.seen_ms < _timeout_ms) continue;
+                event.address = slot.address;
+                event.pressed = 0;
+                event.released = slot.held;
+                event.held = 0;
+                slot.used = false;
+                return true;
+            }
+            return false;
+        }
+
+        void clear() {
+            for (uint16_t i = 0; i < SLOTS; i++) _slots[i].used = false;
+            _eviction_count = 0;
+        }
+
+        uint16_t getEvictionCount() const { return _eviction_count; } // Addresses recycled while holding buttons
+
+    protected:
+        static const uint16_t SLOTS = uint16_t(1) << SLOT_BITS;
+
+        struct Slot {
+            uint32_t address;
+            uint32_t seen_ms; // Time of the last frame, for the timeout and recycling
+            uint16_t held;
+            bool used;
+        };
+
+        // Slot of the address; if it has none, a new one when 'create' (first free slot, else the least recently seen)
+        Slot *find(const uint32_t address, const uint32_t now_ms, const bool create) {
+            uint16_t index = uint16_t((address * 2654435761UL) >> (32 - SLOT_BITS)) & (SLOTS - 1);
+            Slot *candidate = nullptr;
+            uint32_t oldest_age = 0;
+
+            for (uint8_t p = 0; p < PROBES && p < SLOTS; p++) {
+                Slot &slot = _slots[(index + p) & (SLOTS - 1)];
+                if (!slot.used) {
+                    if (!candidate || candidate -> used) candidate = &slot;
+                    continue;
+                }
+                if (slot.address == address) return &slot;
+                uint32_t age = now_ms - slot.seen_ms;
+                if (!candidate || (candidate -> used && age >= oldest_age)) {
+                    candidate = &slot;
+                    oldest_age = age;
+                }
+            }
+            if (!create) return nullptr;
+
+            if (candidate -> used) _eviction_count++;
+            candidate -> address = address;
+            candidate -> held = 0;
+            return candidate;
+        }
+
+        Slot _slots[SLOTS];
+        uint16_t _data_mask;
+        uint16_t _timeout_ms;
+        uint16_t _eviction_count;
+
+        static_assert(SLOT_BITS >= 1 && SLOT_BITS <= 8, "HT600ButtonTracker: SLOT_BITS must be 1 to 8");
+        static_assert(PROBES >= 1, "HT600ButtonTracker: PROBES must be at least 1");
+};
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef HT600_CHANNEL_H
+#define HT600_CHANNEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "HT600.h"
+
+/**
+ * @section CHANNEL
+ * A continuous carrier holds the receiver output HIGH, a jammer fills it with pulses that never form a
+ * frame: in both cases the decoder just stays in IDLE or keeps restarting READING. HT600ChannelStats is
+ * a stats policy that counts the edges seen by the decoder, and classifies the channel from its counters
+ * over fixed windows of WINDOW_MS:
+ * - CARRIER_HOLD: no edge during the window, output HIGH.
+ * - JAMMED:       no frame during the window, and at least MAX_EDGES edges (pulse flood) or MAX_REJECTS
+ *                 frames rejected after a pilot (pulses that look like frames but never complete).
+ * - CLEAR:        anything else (a quiet LOW output, receiver noise, frames).
+ * The channel enters a state after WINDOWS consecutive windows in it (e.g., 3 x 100ms) and goes back to
+ * CLEAR after twice as many clear windows, so that it does not flap around the thresholds.
+ *
+ * Idle receivers differ a lot (superregenerative ones output thousands of noise edges per second):
+ * read getWindowEdges() on a quiet channel and set MAX_EDGES well above it.
+ */
+
+enum class HT600_CHANNEL : uint8_t {
+    CLEAR,        // Normal operation
+    CARRIER_HOLD, // Output stuck HIGH: continuous carrier
+    JAMMED        // Pulses without frames
+};
+
+/**
+ * @brief HT600Stats (or another stats policy derived from it) plus channel classification.
+ * @tparam WINDOW_MS Length of a classification window.
+ * @tparam WINDOWS Consecutive abnormal windows before reporting a state (detection time = WINDOWS * WINDOW_MS).
+ * @tparam MAX_EDGES Edges per window (without frames) that mean a pulse flood.
+ * @tparam MAX_REJECTS Rejected frames per window (without frames) that mean a jammer.
+ * @tparam Base Stats policy providing the counters (HT600Stats or HT600PartialStats).
+ */
+template <uint16_t WINDOW_MS = 100, uint8_t WINDOWS = 3, uint16_t MAX_EDGES = 2000, uint16_t MAX_REJECTS = 4, class Base = HT600Stats>
+class HT600ChannelStats : public Base {
+    public:
+        HT600_INLINE void onEdge(const bool pinState) {
+            _edge_count = _edge_count + 1;
+            _level = pinState;
+        }
+
+        /**
+         * @brief Closes the current window when WINDOW_MS have elapsed and updates the channel state.
+         * Call it from loop() (on 8-bit MCUs with interrupts disabled, since the counters are 16-bit).
+         * @param now_ms Current time (e.g., millis()), wrapping around is fine.
+         * @param state Out: the new state, when it changes.
+         * @return true if the channel state changed.
+         */
+        bool poll(const uint32_t now_ms, HT600_CHANNEL &state) {
+            if (!_started) {
+                _started = true;
+                _window_start = now_ms;
+                snapshot();
+                return false;
+            }
+            if (now_ms - _window_start < WINDOW_MS) return false;
+            _window_start = now_ms;
+
+            uint16_t edges = _edge_count, frames = this -> getFrameCount(), rejects = rejectCount();
+            _window_edges = edges - _last_edges;
+            _window_rejects = rejects - _last_rejects;
+            uint16_t window_frames = frames - _last_frames;
+            snapshot();
+
+            HT600_CHANNEL window = HT600_CHANNEL::CLEAR;
+            if (_window_edges == 0 && _level) {
+                window = HT600_CHANNEL::CARRIER_HOLD;
+            } else if (window_frames == 0 && (_window_edges >= MAX_EDGES || _window_rejects >= MAX_REJECTS)) {
+                window = HT600_CHANNEL::JAMMED;
+            }
+
+            if (window == _candidate) {
+                if (_run < 255) _run++;
+            } else {
+                _candidate = window;
+                _run = 1;
+            }
+
+            uint16_t needed = (window == HT600_CHANNEL::CLEAR) ? uint16_t(WINDOWS) * 2 : WINDOWS;
+            if (window == _state || _run < needed) return false;
+            _state = window;
+            _change_count++;
+            state = _state;
+            return true;
+        }
+
+        HT600_CHANNEL getChannelState() const { return _state; }
+        uint16_t getChangeCount() const { return _change_count; }      // State changes reported by poll()
+        uint16_t getEdgeCount() const { return _edge_count; }          // Transitions, glitches included
+        uint16_t getWindowEdges() const { return _window_edges; }      // Edges in the last closed window
+        uint16_t getWindowRejects() const { return _window_rejects; }  // Rejects in the last closed window
+
+        void resetStats() {
+            Base::resetStats();
+            _edge_count = 0;
+            _started = false;
+            _state = HT600_CHANNEL::CLEAR;
+            _candidate = HT600_CHANNEL::CLEAR;
+            _run = 0;
+            _change_count = 0;
+        }
+
+    protected:
+        uint16_t rejectCount() const {
+            return this -> getTimingRejectCount() + this -> getSyncRejectCount() + this -> getSymbolRejectCount();
+        }
+
+        void snapshot() {
+            _last_edges = _edge_count;
+            _last_frames = this -> getFrameCount();
+            _last_rejects = rejectCount();
+        }
+
+        volatile uint16_t _edge_count = 0;
+        volatile bool _level = false;
+
+        uint32_t _window_start = 0;
+        uint16_t _last_edges = 0;
+        uint16_t _last_frames = 0;
+        uint16_t _last_rejects = 0;
+        uint16_t _window_edges = 0;
+        uint16_t _window_rejects = 0;
+        uint16_t _change_count = 0;
+        HT600_CHANNEL _state = HT600_CHANNEL::CLEAR;
+        HT600_CHANNEL _candidate = HT600_CHANNEL::CLEAR;
+        uint8_t _run = 0;
+        bool _started = false;
+
+        static_assert(WINDOW_MS > 0, "HT600ChannelStats: WINDOW_MS must be non-zero");
+        static_assert(WINDOWS > 0 && WINDOWS <= 127, "HT600ChannelStats: WINDOWS must be 1 to 127");
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef HT600_CLOCK_H
+#define HT600_CLOCK_H
+
+#include <stdint.h>
+
+/**
+ * @section CLOCKS
+ * A clock policy tells the decoder how fast its ticks are, at compile time:
+ * - countsPerUs(): Counts per microsecond of the source. The timing policy then right-shifts the time
+ *                  between transitions so that the pulse windows fit in 16 bits (see tickShift()).
+ * - tick_type:     Width of the counter. 16-bit hardware counters must be used with HT600CompactState.
+ * - now():         Current counter value (platform clocks only, see HT600PlatformClocks.h).
+ * - begin():       Starts the counter if the hardware needs it (platform clocks only).
+ */
+
+/**
+ * @brief Ticks provided by the application, one every TICK_LENGTH_US microseconds (e.g., 1 for micros()).
+ * Only carries the conversion constants: there is no now(), so feed the decoder with handleInterrupt().
+ */
+template <uint16_t TICK_LENGTH_US = 1>
+class HT600TickClock {
+    public:
+        typedef uint32_t tick_type;
+
+        static constexpr double countsPerUs() { return 1.0 / TICK_LENGTH_US; }
+        static constexpr double tickLengthUs() { return TICK_LENGTH_US; }
+
+    private:
+        static_assert(TICK_LENGTH_US > 0, "HT600TickClock: TICK_LENGTH_US must be non-zero");
+};
+
+/**
+ * @brief Base for free-running counters at COUNTS_PER_SECOND. Platform clocks derive from it and add now().
+ */
+template <uint32_t COUNTS_PER_SECOND, class TickType = uint32_t>
+class HT600CounterClock {
+    public:
+        typedef TickType tick_type;
+
+        static constexpr double countsPerUs() { return COUNTS_PER_SECOND / 1000000.0; }
+        static constexpr double tickLengthUs() { return 1000000.0 / COUNTS_PER_SECOND; }
+
+        static void begin() {}
+};
+
+/**
+ * @brief Right-shift that brings a pulse window of 'ticks' within 16 bits.
+ * Slow oscillators (e.g., HT680_1M5_FOSC, HT680_2M0_FOSC) with 1us ticks, or fast clocks
+ * (CPU cycles, nanoseconds), have a pilot window above 65535 ticks: the decoder then divides every
+ * delta by 2^shift, keeping the cheapest compares in the ISR at the cost of some resolution.
+ */
+constexpr uint8_t HT600_tickShift(const double ticks, const uint8_t shift = 0) {
+    return (ticks > 65535.0 && shift < 31) ? HT600_tickShift(ticks / 2.0, shift + 1) : shift;
+}
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef HT600_MERGE_H
+#define HT600_MERGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @section MERGE
+ * Several gateways hear the same button press, and a held button repeats its frame: the merger
+ * collapses all the copies of the same code (HT600Frame::packed()) from any gateway into one press.
+ *
+ * A frame belongs to the press of its code as long as it is within 'window' of the last copy seen
+ * (earlier or later: the gateways' streams do not need to be perfectly ordered). A longer silence
+ * ends the press, and the next copy starts a new one.
+ * Times are in any unit (usually ms) on a common clock; a constant per-gateway offset can be set for
+ * gateways stamping frames with their own clock.
+ *
+ * The open presses are kept in a fixed hash table of 2^SLOT_BITS entries with at most PROBES slots
+ * visited per frame: constant time, bounded memory. Size it for the codes active within one window
+ * (getEvictionCount() tells if it is too small).
+ */
+
+// A press: first copy heard, by any gateway
+struct HT600Press {
+    uint32_t time;   // Time of the first copy (gateway offset applied)
+    uint32_t packed; // The code (HT600Frame::packed())
+    uint8_t gateway; // Gateway that heard it first
+};
+
+template <uint8_t SLOT_BITS = 6, uint8_t PROBES = 8>
+class HT600FrameMerger {
+    public:
+        static const uint8_t MAX_GATEWAYS = 32;
+
+        /**
+         * @param window Maximum gap between two copies of the same press (e.g., 200 ms: longer than the
+         * encoder repeat interval and the network jitter, shorter than two separate presses).
+         */
+        explicit HT600FrameMerger(const uint32_t window) : _window(window) {
+            for (uint8_t g = 0; g < MAX_GATEWAYS; g++) _offset[g] = 0;
+            clear();
+        }
+
+        // Added to the times of this gateway to bring them on the common clock
+        void setOffset(const uint8_t gateway, const int32_t offset) {
+            if (gateway < MAX_GATEWAYS) _offset[gateway] = offset;
+        }
+
+        /**
+         * @brief Adds a frame heard by a gateway.
+         * @param gateway Gateway index (0 to MAX_GATEWAYS - 1).
+         * @param time Reception time, on the gateway clock.
+         * @param packed The frame (HT600Frame::packed()).
+         * @param press Out: the new press, when the frame starts one.
+         * @return true if the frame starts a new press, false if it is a copy of an open one (or an invalid gateway).
+         */
+        bool push(const uint8_t gateway, const uint32_t time, const uint32_t packed, HT600Press &press) {
+            if (gateway >= MAX_GATEWAYS) return false;
+            uint32_t t = time + uint32_t(_offset[gateway]);
+            _frame_count++;
+
+            uint16_t index = uint16_t((packed * 2654435761UL) >> (32 - SLOT_BITS)) & (SLOTS - 1);
+            Entry *candidate = nullptr;
+            uint32_t oldest_age = 0;
+
+            for (uint8_t p = 0; p < PROBES && p < SLOTS; p++) {
+                Entry &entry = _entries[(index + p) & (SLOTS - 1)];
+                int32_t age = int32_t(t - entry.last); // Negative for a copy older than the last one
+
+                if (entry.used && entry.packed == packed) {
+                    // Within the window on either side of the press: same press
+                    if (age <= int32_t(_window) && int32_t(entry.first - t) <= int32_t(_window)) {
+                        if (age > 0) entry.last = t;
+                        if (int32_t(entry.first - t) > 0) entry.first = t;
+                        entry.gateways |= uint32_t(1) << gateway;
+                        _duplicate_count++;
+                        return false;
+                    }
+                    candidate = &entry; // Same code, press over: reuse its entry
+                    break;
+                }
+                // Prefer a free entry, then the least recently updated one
+                uint32_t rank = !entry.used ? 0xFFFFFFFF : (age < 0) ? 0 : uint32_t(age);
+                if (!candidate || rank > oldest_age) {
+                    candidate = &entry;
+                    oldest_age = rank;
+                }
+            }
+
+            if (candidate -> used && candidate -> packed != packed && int32_t(t - candidate -> last) <= int32_t(_window)) {
+                _eviction_count++; // An open press is lost: more slots needed
+            }
+
+            candidate -> used = true;
+            candidate -> packed = packed;
+            candidate -> first = t;
+            candidate -> last = t;
+            candidate -> gateways = uint32_t(1) << gateway;
+            _press_count++;
+
+            press.time = t;
+            press.packed = packed;
+            press.gateway = gateway;
+            return true;
+        }
+
+        /**
+         * @brief Gateways that heard the open press of a code so far (bit g = gateway g), 0 if none.
+         */
+        uint32_t getGateways(const uint32_t packed) const {
+            uint16_t index = uint16_t((packed * 2654435761UL) >> (32 - SLOT_BITS)) & (SLOTS - 1);
+            for (uint8_t p = 0; p < PROBES && p < SLOTS; p++) {
+                const Entry &entry = _entries[(index + p) & (SLOTS - 1)];
+                if (entry.used && entry.packed == packed) return entry.gateways;
+            }
+            return 0;
+        }
+
+        void clear() {
+            for (uint16_t i = 0; i < SLOTS; i++) _entries[i].used = false;
+            _frame_count = 0;
+            _press_count = 0;
+            _duplicate_count = 0;
+            _eviction_count = 0;
+        }
+
+        uint32_t getFrameCount() const { return _frame_count; }         // Frames pushed
+        uint32_t getPressCount() const { return _press_count; }         // Presses started
+        uint32_t getDuplicateCount() const { return _duplicate_count; } // Copies collapsed
+        uint32_t getEvictionCount() const { return _eviction_count; }   // Open presses recycled (table too small)
+
+    protected:
+        static const uint16_t SLOTS = uint16_t(1) << SLOT_BITS;
+
+        struct Entry {
+            uint32_t packed;
+            uint32_t first;
+            uint32_t last;
+            uint32_t gateways;
+            bool used;
+        };
+
+        Entry _entries[SLOTS];
+        int32_t _offset[MAX_GATEWAYS];
+        uint32_t _window;
+        uint32_t _frame_count;
+        uint32_t _press_count;
+        uint32_t _duplicate_count;
+        uint32_t _eviction_count;
+
+        static_assert(SLOT_BITS >= 1 && SLOT_BITS <= 15, "HT600FrameMerger: SLOT_BITS must be 1 to 15");
+        static_assert(PROBES >= 1, "HT600FrameMerger: PROBES must be at least 1");
+};
+
+#endif
@@ -0,0 +1,329 @@
+#ifndef HT600_PIO_H
+#define HT600_PIO_H
+
+/**
+ * @section RP2040 PIO CAPTURE
+ * A PIO state machine measures the LOW and HIGH lengths of the receiver output and pushes them into
+ * its RX FIFO, a DMA channel copies them into a ring buffer, and the main loop drains the ring into
+ * the decoder with handleDurations(). No interrupt and no CPU time per edge.
+ *
+ * - HT600PioClock<FOSC, TOLERANCE_PCT, SYS_HZ>: clock policy for the PIO counts. The clock divider is
+ *   derived from the oscillator so that the pilot window uses ~90% of 16 bits (best resolution,
+ *   no prescaling).
+ * - HT600PulseRing<RING_BITS>: hardware independent ring drain (testable on host: fill buffer() and
+ *   pass the number of words written, as the DMA would).
+ * - HT600DmaCapture<Dma, Ring>: hardware independent poll() of a ring written by a DMA channel, which
+ *   it re-arms before the transfer count runs out. The channel is a parameter (see below), so the
+ *   equivalence harness runs it on host against a model of the PIO FIFO and DMA channel.
+ * - HT600PioDma: that channel on RP2040/RP2350, reading the RX FIFO of a state machine.
+ * - HT600PioCapture<Decoder, RING_BITS>: PIO program + DMA setup (RP2040/RP2350 only).
+ *
+ *   typedef HT600PioClock<HT680_330K_FOSC> PioClock;
+ *   HT600Decoder<HT600FixedTiming<HT680_330K_FOSC, 30, PioClock>, HT600TrinaryOutput, HT600NoStats, HT600FixedFilter<50, PioClock>> decoder;
+ *   HT600PioCapture<decltype(decoder)> capture;
+ *   capture.begin(RF_PIN, PioClock::DIV_INT, PioClock::DIV_FRAC);
+ *   loop(): capture.poll(decoder); if (decoder.available()) { ...; decoder.releaseFrame(); }
+ */
+
+#include "HT600.h"
+
+#if defined(ARDUINO_ARCH_RP2040) || defined(PICO_BOARD)
+  #include <hardware/pio.h>
+  #include <hardware/dma.h>
+  #define HT600_HAS_PIO
+#endif
+
+#if !defined(F_CPU)
+  #define HT600_PIO_SYS_HZ 125000000UL // RP2040 default system clock
+#else
+  #define HT600_PIO_SYS_HZ F_CPU
+#endif
+
+/**
+ * @brief PIO counter rate putting the pilot window (36T + tolerance) on 90% of 16 bits.
+ */
+constexpr double HT600_pioCountsPerUs(const uint16_t fosc_khz, const uint8_t tolerance_pct) {
+    return 0.9 * 65535.0 / ((33000.0 / fosc_khz) * 36.0 * (100 + tolerance_pct) / 100.0);
+}
+
+/**
+ * @brief State machine divider for that rate, in 1/256 steps (one count = 2 cycles).
+ */
+constexpr uint32_t HT600_pioDivX256(const uint32_t sys_hz, const uint16_t fosc_khz, const uint8_t tolerance_pct) {
+    // Fast oscillators want more than sys_hz / 2: run at full speed, the pilot window still fits
+    return (sys_hz / (2.0 * HT600_pioCountsPerUs(fosc_khz, tolerance_pct) * 1000000.0) < 1.0) ? 256 :
+           uint32_t(sys_hz / (2.0 * HT600_pioCountsPerUs(fosc_khz, tolerance_pct) * 1000000.0) * 256.0 + 0.5);
+}
+
+/**
+ * @brief Clock policy of the PIO pulse counter (one count = 2 state machine cycles).
+ * @tparam FOSC_KHZ Oscillation frequency (use HT680_XXXK_FOSC macros).
+ * @tparam TOLERANCE_PCT Tolerance used by the decoder, in percent.
+ * @tparam SYS_HZ System clock of the RP2040.
+ */
+template <uint16_t FOSC_KHZ, uint8_t TOLERANCE_PCT = 30, uint32_t SYS_HZ = HT600_PIO_SYS_HZ>
+class HT600PioClock {
+    public:
+        typedef uint32_t tick_type;
+
+        // State machine divider in 1/256 steps (16.8 fixed point), as set by sm_config_set_clkdiv_int_frac()
+        static const uint32_t DIV_X256 = HT600_pioDivX256(SYS_HZ, FOSC_KHZ, TOLERANCE_PCT);
+        static const uint16_t DIV_INT  = uint16_t(DIV_X256 >> 8);
+        static const uint8_t  DIV_FRAC = uint8_t(DIV_X256 & 0xFF);
+
+        // Actual rate, from the quantized divider
+        static constexpr double countsPerUs() { return SYS_HZ * 256.0 / (2.0 * DIV_X256) / 1000000.0; }
+        static constexpr double tickLengthUs() { return 1.0 / countsPerUs(); }
+
+    private:
+        static_assert(DIV_X256 <= 0xFFFFFF, "HT600PioClock: clock divider above 65535");
+};
+
+/**
+ * @brief Ring of pulse lengths written by DMA (or by a test), drained into the decoder.
+ * The PIO program always starts on a LOW level, so the level of pulse n is n & 1 (0: LOW).
+ * @tparam RING_BITS The ring holds 2^RING_BITS words and is aligned on its size (DMA ring wrapping).
+ */
+template <uint8_t RING_BITS = 8>
+class HT600PulseRing {
+    public:
+        static const uint8_t BITS = RING_BITS;
+        static const uint16_t SIZE = 1 << RING_BITS;
+
+        // Storage to hand over to the DMA channel
+        uint32_t *buffer() { return _ring; }
+
+        /**
+         * @brief Feeds the decoder with the pulses written since the last call.
+         * Stops after a complete frame (see HT600Decoder::handleDurations()): call again once it is read.
+         * @param written Total number of words written into the ring so far (wraps at 2^32).
+         * @return The number of pulses consumed.
+         */
+        template <class Decoder>
+        uint16_t drain(Decoder &decoder, const uint32_t written) {
+            // Make sure the words written by the DMA are read from memory
+            __asm__ __volatile__("" ::: "memory");
+
+            if (written - _read > SIZE) {
+                // The writer lapped the reader: the oldest pulses are lost, and so is the time base
+                _read = written - SIZE;
+                _overrun_count++;
+                if (decoder.getState() != HT600_STATE::DONE) decoder.resetAvailable();
+            }
+
+            uint16_t consumed = 0;
+            while (_read != written) {
+                uint16_t index = _read & (SIZE - 1);
+                // Contiguous run up to the end of the ring
+                uint32_t run = written - _read;
+                if (run > uint32_t(SIZE - index)) run = SIZE - index;
+
+                bool level = _read & 1;
+                uint16_t n = decoder.handleDurations(&_ring[index], uint16_t(run), level, _ticks);
+                _read += n;
+                consumed += n;
+                if (n < run) break; // Frame available
+            }
+            return consumed;
+        }
+
+        uint16_t getOverrunCount() const { return _overrun_count; }
+
+    protected:
+        alignas(4 << RING_BITS) uint32_t _ring[SIZE];
+        uint32_t _read = 0;  // Total number of words read
+        uint32_t _ticks = 0; // Running timestamp of the decoder
+        uint16_t _overrun_count = 0;
+
+        static_assert(RING_BITS >= 1 && RING_BITS <= 13, "HT600PulseRing: RING_BITS must be 1 to 13 (DMA ring up to 32 KB)");
+};
+
+/**
+ * @brief Ring written by a DMA channel, drained into the decoder by poll(). A run of the channel lasts
+ * Dma::MAX_COUNT transfers: poll() re-arms it once half of them are written (or if it ever stops),
+ * long before it runs out. The pulses pushed while the channel is stopped wait in the FIFO it reads.
+ * @tparam Dma Channel access (HT600PioDma on RP2040/RP2350, a model on host):
+ *   static const uint32_t MAX_COUNT;                     Transfers per run
+ *   uint32_t remaining() const;                          Transfers left in the current run
+ *   bool busy() const;
+ *   void abort();                                        Stops the run (remaining() stays valid)
+ *   void start(uint32_t *write, uint8_t ring_bits, uint32_t count);  Starts a run at write, wrapping
+ *                                                        the address on 2^ring_bits words
+ * @tparam Ring HT600PulseRing (or a class derived from it).
+ */
+template <class Dma, class Ring = HT600PulseRing<8>>
+class HT600DmaCapture {
+    public:
+        // Starts the first run at the beginning of the ring
+        void start(Dma &dma) {
+            _written_base = 0;
+            arm(dma);
+        }
+
+        // Drains the pulses written so far into the decoder, re-arms the channel if needed
+        template <class Decoder>
+        uint16_t poll(Decoder &decoder, Dma &dma) {
+            uint16_t consumed = _ring.drain(decoder, written(dma));
+
+            if (!dma.busy() || dma.remaining() < Dma::MAX_COUNT / 2) {
+                dma.abort();
+                _written_base = written(dma);
+                arm(dma);
+            }
+            return consumed;
+        }
+
+        uint16_t getOverrunCount() const { return _ring.getOverrunCount(); }
+
+    protected:
+        uint32_t written(const Dma &dma) const { return _written_base + (Dma::MAX_COUNT - dma.remaining()); }
+
+        // Resumes writing where the ring left off
+        void arm(Dma &dma) {
+            dma.start(_ring.buffer() + (_written_base & (Ring::SIZE - 1)), Ring::BITS, Dma::MAX_COUNT);
+        }
+
+        Ring _ring;
+        uint32_t _written_base = 0; // Words written by the previous runs
+};
+
+
+#if defined(HT600_HAS_PIO)
+
+/**
+ * @brief PIO program (hand assembled, equivalent pioasm source below).
+ *
+ *     .program ht600_capture
+ *         wait 0 pin 0        ; 0: start on a LOW level
+ *     .wrap_target
+ *         mov x, ~null        ; 1: x = 0xFFFFFFFF
+ *     low:
+ *         jmp pin low_end     ; 2: HIGH -> the LOW pulse is over
+ *         jmp x-- low         ; 3: 2 cycles per count
+ *     low_end:
+ *         mov isr, ~x         ; 4: count = ~x
+ *         push noblock        ; 5
+ *         mov x, ~null        ; 6
+ *     high:
+ *         jmp x-- high_test   ; 7: 2 cycles per count
+ *     high_test:
+ *         jmp pin high        ; 8: still HIGH
+ *         mov isr, ~x         ; 9
+ *         push noblock        ; 10
+ *     .wrap
+ *
+ * Each pulse loses the 3 cycles (1.5 counts) spent pushing the previous one: negligible against
+ * the windows, and the same for LOW and HIGH.
+ */
+static const uint16_t HT600_PIO_PROGRAM_INSTRUCTIONS[] = {
+    0x2020, //  0: wait   0 pin, 0
+    0xa02b, //  1: mov    x, ~null
+    0x00c4, //  2: jmp    pin, 4
+    0x0042, //  3: jmp    x--, 2
+    0xa0c9, //  4: mov    isr, ~x
+    0x8000, //  5: push   noblock
+    0xa02b, //  6: mov    x, ~null
+    0x0048, //  7: jmp    x--, 8
+    0x00c7, //  8: jmp    pin, 7
+    0xa0c9, //  9: mov    isr, ~x
+    0x8000, // 10: push   noblock
+};
+
+static const struct pio_program HT600_PIO_PROGRAM = {
+    HT600_PIO_PROGRAM_INSTRUCTIONS,
+    sizeof(HT600_PIO_PROGRAM_INSTRUCTIONS) / sizeof(HT600_PIO_PROGRAM_INSTRUCTIONS[0]),
+    -1, // Relocatable
+};
+
+#define HT600_PIO_WRAP_TARGET 1
+#define HT600_PIO_WRAP        10
+
+/**
+ * @brief DMA channel copying the RX FIFO of a PIO state machine (Dma parameter of HT600DmaCapture).
+ */
+class HT600PioDma {
+    public:
+        // Transfers per run. On RP2350 the top 4 bits of TRANS_COUNT are the mode (0xF: endless, the
+        // count never decreases): keep the count below 2^28 and mask the mode bits when reading it
+        static const uint32_t MAX_COUNT = 0x0FFFFFFF;
+
+        void attach(PIO pio, const uint8_t sm, const uint8_t channel) {
+            _pio = pio;
+            _sm = sm;
+            _channel = channel;
+        }
+
+        uint32_t remaining() const { return dma_channel_hw_addr(_channel) -> transfer_count & MAX_COUNT; }
+        bool busy() const { return dma_channel_is_busy(_channel); }
+        void abort() { dma_channel_abort(_channel); }
+
+        void start(uint32_t *write, const uint8_t ring_bits, const uint32_t count) {
+            dma_channel_config c = dma_channel_get_default_config(_channel);
+            channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+            channel_config_set_read_increment(&c, false);
+            channel_config_set_write_increment(&c, true);
+            channel_config_set_ring(&c, true, ring_bits + 2); // Wrap the write address on the ring size in bytes
+            channel_config_set_dreq(&c, pio_get_dreq(_pio, _sm, false));
+            dma_channel_configure(_channel, &c, write, &_pio -> rxf[_sm], count, true);
+        }
+
+    protected:
+        PIO _pio;
+        uint8_t _sm;
+        uint8_t _channel;
+};
+
+/**
+ * @brief PIO + DMA front-end: HT600DmaCapture on an HT600PioDma channel.
+ */
+template <class Decoder, uint8_t RING_BITS = 8>
+class HT600PioCapture {
+    public:
+        /**
+         * @brief Loads the program, starts the state machine and the DMA channel.
+         * @param pin Receiver data pin.
+         * @param div_int, div_frac State machine clock divider (use HT600PioClock::DIV_INT / DIV_FRAC).
+         * @param pio PIO block to use.
+         * @return false if no state machine, DMA channel or program space is available.
+         */
+        bool begin(const uint8_t pin, const uint16_t div_int, const uint8_t div_frac, PIO pio = pio0) {
+            if (!pio_can_add_program(pio, &HT600_PIO_PROGRAM)) return false;
+            int sm = pio_claim_unused_sm(pio, false);
+            if (sm < 0) return false;
+            int dma = dma_claim_unused_channel(false);
+            if (dma < 0) {
+                pio_sm_unclaim(pio, sm);
+                return false;
+            }
+            _dma.attach(pio, uint8_t(sm), uint8_t(dma));
+
+            uint offset = pio_add_program(pio, &HT600_PIO_PROGRAM);
+            pio_sm_config c = pio_get_default_sm_config();
+            sm_config_set_wrap(&c, offset + HT600_PIO_WRAP_TARGET, offset + HT600_PIO_WRAP);
+            sm_config_set_in_pins(&c, pin);
+            sm_config_set_jmp_pin(&c, pin);
+            sm_config_set_in_shift(&c, false, false, 32);
+            sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_RX);
+            sm_config_set_clkdiv_int_frac(&c, div_int, div_frac);
+            pio_gpio_init(pio, pin);
+            pio_sm_set_consecutive_pindirs(pio, sm, pin, 1, false);
+            pio_sm_init(pio, sm, offset, &c);
+
+            _capture.start(_dma);
+            pio_sm_set_enabled(pio, sm, true);
+            return true;
+        }
+
+        // Drains the pulses captured so far into the decoder (call it from loop())
+        uint16_t poll(Decoder &decoder) { return _capture.poll(decoder, _dma); }
+
+        uint16_t getOverrunCount() const { return _capture.getOverrunCount(); }
+
+    protected:
+        HT600DmaCapture<HT600PioDma, HT600PulseRing<RING_BITS>> _capture;
+        HT600PioDma _dma;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef HT600_PLATFORM_CLOCKS_H
+#define HT600_PLATFORM_CLOCKS_H
+
+/**
+ * @brief Clock policies reading the platform counters directly (see @section CLOCKS in HT600Clock.h).
+ * Use them with HT600ClockTiming<Clock> (or HT600FixedTiming<..., Clock>) and feed the decoder with
+ * handleEdge(pinState): the ISR no longer needs micros(), which on AVR disables interrupts itself.
+ *
+ *   HT600Decoder<HT600ClockTiming<HT600Esp32CycleClock>> decoder(HT680_330K_FOSC, 0.3f, 50);
+ *   void IRAM_ATTR handleInterrupt() { decoder.handleEdge(digitalRead(RF_PIN)); }
+ */
+
+#include "HT600.h"
+
+#if defined(ARDUINO)
+  #include <Arduino.h>
+#endif
+
+#if defined(ARDUINO)
+// micros(): 1 tick per microsecond on every Arduino core
+class HT600MicrosClock : public HT600CounterClock<1000000UL> {
+    public:
+        static HT600_INLINE uint32_t now() { return micros(); }
+};
+#endif
+
+#if defined(__AVR__) && defined(TCNT1H)
+/**
+ * @brief 16-bit Timer1 (ATmega), F_CPU / PRESCALER counts per second. Requires HT600CompactState.
+ * begin() takes over Timer1 (normal mode): it can not be shared with Servo, tone(), etc.
+ * The pilot window must fit in 65535 counts: at 16 MHz use PRESCALER 8 up to HT680_680K_FOSC,
+ * 64 for slower oscillators (HT600ClockTiming refuses them with PRESCALER 8, see isConfigured()).
+ */
+template <uint16_t PRESCALER = 8>
+class HT600AvrTimer1Clock : public HT600CounterClock<F_CPU / PRESCALER, uint16_t> {
+    public:
+        static HT600_INLINE uint32_t now() { return TCNT1; }
+
+        static void begin() {
+            TCCR1A = 0;
+            TCCR1B = (PRESCALER == 1)   ? _BV(CS10) :
+                     (PRESCALER == 8)   ? _BV(CS11) :
+                     (PRESCALER == 64)  ? (_BV(CS11) | _BV(CS10)) :
+                     (PRESCALER == 256) ? _BV(CS12) : (_BV(CS12) | _BV(CS10));
+        }
+
+    private:
+        static_assert(PRESCALER == 1 || PRESCALER == 8 || PRESCALER == 64 || PRESCALER == 256 || PRESCALER == 1024,
+                      "HT600AvrTimer1Clock: PRESCALER must be 1, 8, 64, 256 or 1024");
+};
+#endif
+
+#if defined(ESP32)
+// Xtensa/RISC-V CPU cycle counter (F_CPU counts per second), one instruction to read
+class HT600Esp32CycleClock : public HT600CounterClock<F_CPU> {
+    public:
+        static HT600_INLINE uint32_t now() { return ESP.getCycleCount(); }
+};
+#endif
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__)
+/**
+ * @brief Cortex-M3/M4/M7/M33 DWT cycle counter. The CMSIS device header must be included first.
+ * CPU_HZ must be the core clock (SystemCoreClock is not a compile-time constant).
+ */
+template <uint32_t CPU_HZ>
+class HT600DwtClock : public HT600CounterClock<CPU_HZ> {
+    public:
+        static HT600_INLINE uint32_t now() { return DWT->CYCCNT; }
+
+        static void begin() {
+            CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+            DWT->CYCCNT = 0;
+            DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+        }
+};
+#endif
+
+#if defined(__linux__) && !defined(ARDUINO)
+#include <time.h>
+// CLOCK_MONOTONIC_RAW in nanoseconds (truncated to 32 bits, deltas stay correct across the wrap)
+class HT600PosixClock : public HT600CounterClock<1000000000UL> {
+    public:
+        static inline uint32_t now() {
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+            return uint32_t(uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec);
+        }
+};
+#endif
+
+#endif
@@ -0,0 +1,737 @@
+#ifndef HT600_POLICIES_H
+#define HT600_POLICIES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "HT600Clock.h"
+
+// Policy hooks are called from the ISR: force them inline so that disabled policies vanish
+// and enabled ones never end up as an out-of-line call (or, on ESP32, outside IRAM).
+#if defined(__GNUC__)
+  #define HT600_INLINE inline __attribute__((always_inline))
+#else
+  #define HT600_INLINE inline
+#endif
+
+/**
+ * @section POLICIES
+ * The decoder is assembled from five independent policies (see HT600Decoder in HT600.h):
+ *
+ * - TIMING: Provides the pulse windows (short/long/pilot) in ticks.
+ *           HT600RuntimeTiming computes them in the constructor and keeps them in RAM,
+ *           HT600ClockTiming<Clock> does the same from the rate of a clock policy (see HT600Clock.h),
+ *           HT600FixedTiming<...> bakes them into the code at compile time (0 bytes of RAM).
+ * - OUTPUT: Stores the decoded trits and extracts the received value.
+ *           HT600TrinaryOutput keeps the two 3-byte HL/Z buffers,
+ *           HT600PackedOutput shifts the 16 useful trits into two uint16_t (4 bytes, O(1) getters).
+ * - STATS:  Counts decoder events. HT600NoStats compiles to nothing, HT600Stats keeps counters,
+ *           HT600PartialStats also keeps the trits of the last rejected frame,
+ *           HT600ChannelStats<...> (HT600Channel.h) also classifies the channel (clear, carrier hold, jammed).
+ * - FILTER: Conditioning of the pulse lengths: de-glitch filter on the time between transitions and,
+ *           optionally, LOW/HIGH asymmetry compensation.
+ *           HT600RuntimeFilter (threshold in RAM), HT600FixedFilter<...> (compile-time threshold),
+ *           HT600NoFilter (no filter at all), HT600CompensatingFilter<...> (any of them + bias correction).
+ * - STATE:  Layout of the FSM variables. HT600WideState keeps one field per variable,
+ *           HT600CompactState packs them into 5 bytes.
+ *
+ * Every policy is an empty class when it has nothing to store, so it costs no RAM, and
+ * every hook is an inline no-op when it has nothing to do, so it costs no flash.
+ *
+ * OUTPUT, FILTER and STATE policies also copy their variables to and from an HT600Checkpoint
+ * (save() / restore()), so that a decoder can be suspended between two chunks of input.
+ */
+
+// Reasons for which a frame being read is discarded
+enum class HT600_REJECT : uint8_t {
+    TIMING, // A LOW/HIGH pair does not match any symbol
+    SYNC,   // The two SYNC bits are not SYMBOL0 + SYMBOL1
+    SYMBOL  // The two symbols of a bit form an invalid combination
+};
+
+/**
+ * @brief Everything the decoder remembers between two edges, as a plain struct.
+ * Trivially copyable: it can be memcpy'd, written to a file or sent to another thread, and restored
+ * into a decoder of the same composition (the trits and the timestamp keep the layout of the
+ * policies that saved them). Configuration (timing, filter threshold) and stats are not included.
+ */
+struct HT600Checkpoint {
+    uint32_t last_tick;    // Last accepted transition, as stored by the state policy
+    uint32_t trits_HL;     // Trits stored so far, as laid out by the output policy
+    uint32_t trits_Z;
+    uint16_t period_L;     // LOW period waiting for its falling edge
+    int16_t  bias_x3;      // Asymmetry estimate of HT600CompensatingFilter (0 otherwise)
+    HT600_STATE state;
+    uint8_t  bit_index;
+    bool     half_symbol_read;
+    bool     last_symbol;
+    bool     no_timestamp; // HT600CompactState only: the next delta saturates
+};
+
+/**
+ * @brief True if two decoders in these states decode any following input the same way.
+ * The trits are not compared in IDLE: every position is written again before the next frame is DONE.
+ */
+inline bool HT600_sameState(const HT600Checkpoint &a, const HT600Checkpoint &b) {
+    if (a.state != b.state || a.bit_index != b.bit_index || a.half_symbol_read != b.half_symbol_read ||
+        a.last_symbol != b.last_symbol || a.no_timestamp != b.no_timestamp || a.last_tick != b.last_tick ||
+        a.period_L != b.period_L || a.bias_x3 != b.bias_x3) return false;
+    return a.state == HT600_STATE::IDLE || (a.trits_HL == b.trits_HL && a.trits_Z == b.trits_Z);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// TIMING POLICIES
+// ------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Pulse windows computed at runtime from the constructor parameters (default).
+ * Calculations based on HT680 Datasheet:
+ * - One symbol clock (T) = 1 / (fosc / 33)
+ * - "Short" pulse = 1T
+ * - "Long"  pulse = 2T
+ * - "Pilot" pulse = 36T (Transmission begins with a LOW pulse lasting this interval)
+ */
+class HT600RuntimeTiming {
+    public:
+        void configure(const uint16_t fosc_khz, const float tolerance, const float tick_length_us) {
+            // T (period in microseconds) = 1000 / (fosc_khz / 33) = 33000 / fosc_khz
+            float base_period_us = 33000.0 / fosc_khz;
+
+            // Converting the base period in microseconds to the number of ticks
+            float T_ticks = base_period_us / tick_length_us;
+
+            // Prescaling: halve the ticks until the longest window (pilot) fits in 16 bits
+            _tick_shift = 0;
+            while ((T_ticks * 36.0) * (1.0 + tolerance) > 65535.0) {
+                T_ticks /= 2;
+                _tick_shift++;
+            }
+
+            // Defining pulse length constraints with tolerance:
+            // Short pulse (1T): Used for '0' (H), '1' (L), 'Open' (Both)
+            _short_tick_min = uint16_t(T_ticks * (1.0 - tolerance));
+            _short_tick_max = uint16_t(T_ticks * (1.0 + tolerance));
+
+            // Long pulse (2T): Used for '0' (L), '1' (H)
+            _long_tick_min  = uint16_t((T_ticks * 2.0) * (1.0 - tolerance));
+            _long_tick_max  = uint16_t((T_ticks * 2.0) * (1.0 + tolerance));
+
+            // Pilot period (36T): Minimal LOW duration to identify a new transmission
+            // Since the pilot period is 6 bits long and each bit takes up 6T, it lasts 36T
+            _pilot_tick_min = uint16_t((T_ticks * 36.0) * (1.0 - tolerance));
+            _pilot_tick_max = uint16_t((T_ticks * 36.0) * (1.0 + tolerance));
+        }
+
+        HT600_INLINE uint16_t shortMin() const { return _short_tick_min; }
+        HT600_INLINE uint16_t shortMax() const { return _short_tick_max; }
+        HT600_INLINE uint16_t longMin()  const { return _long_tick_min; }
+        HT600_INLINE uint16_t longMax()  const { return _long_tick_max; }
+        HT600_INLINE uint16_t pilotMin() const { return _pilot_tick_min; }
+        HT600_INLINE uint16_t pilotMax() const { return _pilot_tick_max; }
+
+        // Right-shift applied to every delta (0 unless the pilot window exceeds 16 bits)
+        HT600_INLINE uint8_t tickShift() const { return _tick_shift; }
+
+    protected:
+        uint16_t _short_tick_min;
+        uint16_t _short_tick_max;
+        uint16_t _long_tick_min;
+        uint16_t _long_tick_max;
+        uint16_t _pilot_tick_min;
+        uint16_t _pilot_tick_max;
+        uint8_t _tick_shift;
+};
+
+/**
+ * @brief Runtime pulse windows for the ticks of a clock policy.
+ * Use the (fosc_khz, tolerance, noise_filter_us) constructor of HT600Decoder and feed it with handleEdge().
+ */
+template <class Clock>
+class HT600ClockTiming : public HT600RuntimeTiming {
+    public:
+        typedef Clock clock_type;
+
+        // Same as HT600RuntimeTiming, but a 16-bit clock cannot be prescaled (the shifted counter would wrap
+        // at 2^(16 - shift)): when the pilot window of fosc_khz does not fit in it, every window is left
+        // empty, the decoder accepts nothing and isConfigured() returns false. Use a larger prescaler.
+        void configure(const uint16_t fosc_khz, const float tolerance, const float tick_length_us) {
+            HT600RuntimeTiming::configure(fosc_khz, tolerance, tick_length_us);
+            if (sizeof(typename Clock::tick_type) >= 4 || _tick_shift == 0) return;
+            _short_tick_min = _long_tick_min = _pilot_tick_min = 0xFFFF;
+            _short_tick_max = _long_tick_max = _pilot_tick_max = 0;
+            _tick_shift = 0;
+        }
+
+        // false if configure() refused the oscillator for this clock
+        bool isConfigured() const { return _pilot_tick_min <= _pilot_tick_max; }
+};
+
+/**
+ * @brief Pulse windows computed at compile time. Same formulas as HT600RuntimeTiming.
+ * The constructor parameters are ignored: use the default constructor of HT600Decoder.
+ * @tparam FOSC_KHZ Oscillation frequency (use HT680_XXXK_FOSC macros).
+ * @tparam TOLERANCE_PCT Tolerance in percent (e.g., 30 for 30%).
+ * @tparam Clock The timestamp source (HT600TickClock<TICK_LENGTH_US> or a platform clock).
+ */
+template <uint16_t FOSC_KHZ, uint8_t TOLERANCE_PCT = 30, class Clock = HT600TickClock<1>>
+class HT600FixedTiming {
+    public:
+        typedef Clock clock_type;
+
+        void configure(const uint16_t, const float, const float) {}
+
+        // Same prescaling as HT600RuntimeTiming, resolved at compile time
+        static constexpr uint8_t tickShift() { return HT600_tickShift((T_raw_ticks() * 36.0) * (1.0 + tolerance())); }
+
+        static constexpr uint16_t shortMin() { return uint16_t(T_ticks()          * (1.0 - tolerance())); }
+        static constexpr uint16_t shortMax() { return uint16_t(T_ticks()          * (1.0 + tolerance())); }
+        static constexpr uint16_t longMin()  { return uint16_t((T_ticks() * 2.0)  * (1.0 - tolerance())); }
+        static constexpr uint16_t longMax()  { return uint16_t((T_ticks() * 2.0)  * (1.0 + tolerance())); }
+        static constexpr uint16_t pilotMin() { return uint16_t((T_ticks() * 36.0) * (1.0 - tolerance())); }
+        static constexpr uint16_t pilotMax() { return uint16_t((T_ticks() * 36.0) * (1.0 + tolerance())); }
+
+    private:
+        // Same float intermediates as HT600RuntimeTiming::configure(), so that the windows are identical
+        // to the ones of a runtime decoder built with (FOSC_KHZ, TOLERANCE_PCT / 100.0f, tick length)
+        static constexpr float tolerance() { return float(TOLERANCE_PCT / 100.0); }
+        static constexpr float T_raw_ticks() { return float(33000.0 / FOSC_KHZ) / float(Clock::tickLengthUs()); }
+        static constexpr float T_ticks() { return T_raw_ticks() / float(1UL << tickShift()); }
+
+        static_assert(FOSC_KHZ > 0, "HT600FixedTiming: FOSC_KHZ must be non-zero");
+        static_assert(sizeof(typename Clock::tick_type) >= 4 ||
+                      HT600_tickShift((float(33000.0 / FOSC_KHZ) / float(Clock::tickLengthUs()) * 36.0) * (1.0 + float(TOLERANCE_PCT / 100.0))) == 0,
+                      "HT600FixedTiming: the pilot window does not fit the 16-bit clock, use a slower clock (e.g., a larger prescaler)");
+        static_assert(TOLERANCE_PCT < 100, "HT600FixedTiming: TOLERANCE_PCT must be below 100");
+};
+
+
+// ------------------------------------------------------------------------------------------------
+// OUTPUT POLICIES
+// ------------------------------------------------------------------------------------------------
+
+// Data trits stored before the bit at bit_index (2 SYNC bits first, 16 useful trits at most)
+inline uint8_t HT600_partialTrits(const uint8_t bit_index) {
+    return (bit_index <= 2) ? 0 : (bit_index >= 18) ? 16 : uint8_t(bit_index - 2);
+}
+
+/**
+ * @brief Stores each trit of the frame in two bit-buffers (default).
+ * Since the HT600 is a ternary encoder, we can use 2 bits to represent the 3 possible states of each bit (0, 1, Z).
+ * Simplest way to do this is to use two different buffer, one to store if the bit is '1' and the other to store if the bit is 'Z'.
+ * Since we have 2 sync bits + 18 bits we need 3 bytes for each buffer
+ */
+class HT600TrinaryOutput {
+    public:
+        HT600_INLINE void storeTrit(const uint8_t bit_index, const bool hl, const bool z) {
+            uint8_t byte_idx = bit_index >> 3;
+            uint8_t bit_mask = (1 << (bit_index & 0x07));
+
+            if (hl) _buffer_HL[byte_idx] = _buffer_HL[byte_idx] | bit_mask;
+            else    _buffer_HL[byte_idx] = _buffer_HL[byte_idx] & ~bit_mask;
+
+            if (z)  _buffer_Z[byte_idx]  = _buffer_Z[byte_idx] | bit_mask;
+            else    _buffer_Z[byte_idx]  = _buffer_Z[byte_idx] & ~bit_mask;
+        }
+
+        /**
+         * @brief Extracts the first 16 decoded data bits (bit 17 and 18 are always dummy).
+         * @param z_mapping_value Logical value to assign if a bit is 'Z'.
+         * @return A uint16_t containing the 16 bits of information.
+         */
+        uint16_t getReceivedValue(bool z_mapping_value = 0) const {
+            uint16_t result = 0;
+
+            for (uint8_t i = 0; i < 16; i++) {
+                // Avoid the first two bits (SYNC)
+                uint8_t internal_idx = i + 2;
+                uint8_t byte_idx = internal_idx >> 3;
+                uint8_t bit_mask = (1 << (internal_idx & 0x07));
+
+                // Boolean extraction
+                bool bit_hl = (_buffer_HL[byte_idx] & bit_mask);
+                bool bit_z  = (_buffer_Z[byte_idx] & bit_mask);
+
+                if (bit_z) {
+                    if (z_mapping_value) result |= (1 << i);
+                } else {
+                    if (bit_hl) result |= (1 << i);
+                }
+            }
+            return result;
+        }
+
+        /**
+         * @brief Extracts the High-Z status for the first 16 bits.
+         * @param z_value If true, returns 1 for Z bits and 0 for defined bits.
+         * If false, returns 0 for Z bits and 1 for defined bits (inverted).
+         * @return A uint16_t mask representing the trinary 'Open' states.
+         */
+        uint16_t getTristateValue(bool z_value = 1) const {
+            uint16_t result = 0;
+
+            for (uint8_t i = 0; i < 16; i++) {
+                // Avoid the first two bits (SYNC)
+                uint8_t internal_idx = i + 2;
+                uint8_t byte_idx = internal_idx >> 3;
+                uint8_t bit_mask = (1 << (internal_idx & 0x07));
+
+                // Check if the bit is 'Z'
+                bool is_z = (_buffer_Z[byte_idx] & bit_mask);
+
+                // If z_value is true, we want Z bits to be 1 and defined bits to be 0.
+                // If z_value is false, we want the opposite.
+                if (!(is_z ^ z_value)) {
+                    result |= (1 << i);
+                }
+            }
+            return result;
+        }
+
+        /**
+         * @brief Data trits stored before bit_index (a frame cut short), in the HT600Frame::packed() layout.
+         * The trits that were not read are 0 in both halves.
+         */
+        uint32_t getPartialFrame(const uint8_t bit_index) const {
+            uint8_t trits = HT600_partialTrits(bit_index);
+            uint16_t mask = uint16_t((uint32_t(1) << trits) - 1);
+            return (uint32_t(getTristateValue(1) & mask) << 16) | (getReceivedValue(0) & mask);
+        }
+
+        void save(HT600Checkpoint &checkpoint) const {
+            checkpoint.trits_HL = _buffer_HL[0] | (uint32_t(_buffer_HL[1]) << 8) | (uint32_t(_buffer_HL[2]) << 16);
+            checkpoint.trits_Z  = _buffer_Z[0]  | (uint32_t(_buffer_Z[1])  << 8) | (uint32_t(_buffer_Z[2])  << 16);
+        }
+
+        void restore(const HT600Checkpoint &checkpoint) {
+            for (uint8_t i = 0; i < 3; i++) {
+                _buffer_HL[i] = uint8_t(checkpoint.trits_HL >> (8 * i));
+                _buffer_Z[i]  = uint8_t(checkpoint.trits_Z  >> (8 * i));
+            }
+        }
+
+    protected:
+        volatile uint8_t _buffer_HL [3]; // In this buffer we store the state of the 'H' and 'L' bits
+        volatile uint8_t _buffer_Z  [3]; // In this buffer we store the state of the 'Z' bit
+};
+
+/**
+ * @brief Shifts the 16 useful trits straight into two uint16_t (bit 0 = first trit after SYNC).
+ * Uses 4 bytes instead of 6, avoids variable shifts in the ISR and makes the getters O(1).
+ */
+class HT600PackedOutput {
+    public:
+        HT600_INLINE void storeTrit(const uint8_t bit_index, const bool hl, const bool z) {
+            // Bit 18 and 19 (the last two trits) are dummy: keep the first 16 trits in place
+            if (bit_index >= 18) return;
+            _value_HL = (_value_HL >> 1) | (hl ? 0x8000 : 0);
+            _value_Z  = (_value_Z  >> 1) | (z  ? 0x8000 : 0);
+        }
+
+        // Same semantics as HT600TrinaryOutput::getReceivedValue()
+        uint16_t getReceivedValue(bool z_mapping_value = 0) const {
+            uint16_t z = _value_Z;
+            return (_value_HL & ~z) | (z_mapping_value ? z : 0);
+        }
+
+        // Same semantics as HT600TrinaryOutput::getTristateValue()
+        uint16_t getTristateValue(bool z_value = 1) const {
+            return z_value ? _value_Z : uint16_t(~_value_Z);
+        }
+
+        // Same semantics as HT600TrinaryOutput::getPartialFrame(): the last trits stored are in the high bits
+        uint32_t getPartialFrame(const uint8_t bit_index) const {
+            uint8_t trits = HT600_partialTrits(bit_index);
+            if (trits == 0) return 0;
+            uint16_t z  = _value_Z  >> (16 - trits);
+            uint16_t hl = _value_HL >> (16 - trits);
+            return (uint32_t(z) << 16) | (hl & ~z);
+        }
+
+        void save(HT600Checkpoint &checkpoint) const {
+            checkpoint.trits_HL = _value_HL;
+            checkpoint.trits_Z  = _value_Z;
+        }
+
+        void restore(const HT600Checkpoint &checkpoint) {
+            _value_HL = uint16_t(checkpoint.trits_HL);
+            _value_Z  = uint16_t(checkpoint.trits_Z);
+        }
+
+    protected:
+        volatile uint16_t _value_HL = 0; // '1' trits
+        volatile uint16_t _value_Z  = 0; // 'Z' trits
+};
+
+
+// ------------------------------------------------------------------------------------------------
+// STATS POLICIES
+// ------------------------------------------------------------------------------------------------
+
+// No statistics (default): every hook is an empty inline function
+class HT600NoStats {
+    public:
+        // Called on every transition, before the noise filter (and while a frame is waiting to be read)
+        HT600_INLINE void onEdge(const bool) {}
+        HT600_INLINE void onGlitch() {}
+        HT600_INLINE void onPilot() {}
+        HT600_INLINE void onReject(const HT600_REJECT, const uint8_t) {}
+        // Called on a reject with the output policy, while it still holds the trits read so far
+        template <class Output>
+        HT600_INLINE void onPartialFrame(const Output &, const uint8_t) {}
+        HT600_INLINE void onFrame() {}
+};
+
+/**
+ * @brief Event counters updated by the ISR. Counters wrap around at 65535.
+ * On 8-bit MCUs read them with interrupts disabled, since a uint16_t read is not atomic.
+ */
+class HT600Stats {
+    public:
+        HT600_INLINE void onEdge(const bool) {}
+        HT600_INLINE void onGlitch() { _glitch_count = _glitch_count + 1; }
+        HT600_INLINE void onPilot()  { _pilot_count = _pilot_count + 1; }
+        HT600_INLINE void onReject(const HT600_REJECT reason, const uint8_t) {
+            if (reason == HT600_REJECT::TIMING)    _timing_reject_count = _timing_reject_count + 1;
+            else if (reason == HT600_REJECT::SYNC) _sync_reject_count = _sync_reject_count + 1;
+            else                                   _symbol_reject_count = _symbol_reject_count + 1;
+        }
+        template <class Output>
+        HT600_INLINE void onPartialFrame(const Output &, const uint8_t) {}
+        HT600_INLINE void onFrame() { _frame_count = _frame_count + 1; }
+
+        uint16_t getGlitchCount() const { return _glitch_count; }              // Transitions dropped by the noise filter
+        uint16_t getPilotCount() const { return _pilot_count; }                // Pilot + SYNC start detected
+        uint16_t getTimingRejectCount() const { return _timing_reject_count; } // Frames dropped for a bad pulse length
+        uint16_t getSyncRejectCount() const { return _sync_reject_count; }     // Frames dropped for a bad SYNC pattern
+        uint16_t getSymbolRejectCount() const { return _symbol_reject_count; } // Frames dropped for an invalid bit
+        uint16_t getFrameCount() const { return _frame_count; }                // Complete frames
+
+        void resetStats() {
+            _glitch_count = 0;
+            _pilot_count = 0;
+            _timing_reject_count = 0;
+            _sync_reject_count = 0;
+            _symbol_reject_count = 0;
+            _frame_count = 0;
+        }
+
+    protected:
+        volatile uint16_t _glitch_count = 0;
+        volatile uint16_t _pilot_count = 0;
+        volatile uint16_t _timing_reject_count = 0;
+        volatile uint16_t _sync_reject_count = 0;
+        volatile uint16_t _symbol_reject_count = 0;
+        volatile uint16_t _frame_count = 0;
+};
+
+/**
+ * @brief HT600Stats, plus the trits read by the last frame rejected after its SYNC bits.
+ * A frame cut short by noise still carries the first trits of its address: loop() can take them with
+ * takePartialFrame() and credit the reject to the transmitter (see HT600TrafficStats). Only the last
+ * one is kept: a partial frame not taken before the next reject is counted as lost.
+ */
+class HT600PartialStats : public HT600Stats {
+    public:
+        template <class Output>
+        HT600_INLINE void onPartialFrame(const Output &output, const uint8_t bit_index) {
+            if (bit_index <= 2) return; // Nothing read after SYNC
+            if (_partial_trits) _partial_lost_count = _partial_lost_count + 1;
+            _partial_frame = output.getPartialFrame(bit_index);
+            _partial_trits = HT600_partialTrits(bit_index);
+        }
+
+        /**
+         * @brief Takes the last partial frame, if any (on 8-bit MCUs call it with interrupts disabled).
+         * @param packed Out: the trits read, HT600Frame::packed() layout (the other trits are 0).
+         * @param trits Out: number of trits read (1-16), from the first data trit.
+         * @return false if no frame was rejected since the last call.
+         */
+        bool takePartialFrame(uint32_t &packed, uint8_t &trits) {
+            if (!_partial_trits) return false;
+            packed = _partial_frame;
+            trits = _partial_trits;
+            _partial_trits = 0;
+            return true;
+        }
+
+        uint16_t getPartialLostCount() const { return _partial_lost_count; } // Partial frames overwritten before being taken
+
+        void resetStats() {
+            HT600Stats::resetStats();
+            _partial_trits = 0;
+            _partial_lost_count = 0;
+        }
+
+    protected:
+        volatile uint32_t _partial_frame = 0;
+        volatile uint8_t _partial_trits = 0;
+        volatile uint16_t _partial_lost_count = 0;
+};
+
+
+// ------------------------------------------------------------------------------------------------
+// FILTER POLICIES
+// ------------------------------------------------------------------------------------------------
+
+// Pulse correction hooks of the plain de-glitch filters: nothing to correct
+class HT600NoCompensation {
+    public:
+        // Called at every pilot (start of a frame)
+        HT600_INLINE void restart() {}
+        // Called before classification with the LOW/HIGH pair ending on a falling edge
+        HT600_INLINE void correct(uint16_t &, uint16_t &) const {}
+        // Called with the uncorrected pair once it has been classified as a symbol
+        HT600_INLINE void learn(const uint16_t, const uint16_t, const bool) {}
+
+        void save(HT600Checkpoint &checkpoint) const { checkpoint.bias_x3 = 0; }
+        void restore(const HT600Checkpoint &) {}
+};
+
+// De-glitch filter with the threshold computed in the constructor (default)
+class HT600RuntimeFilter : public HT600NoCompensation {
+    public:
+        void configure(const uint16_t noise_filter_us, const float tick_length_us) {
+            // Noise filter threshold in ticks
+            _noise_filter_tick = uint16_t(noise_filter_us / tick_length_us);
+        }
+
+        // The threshold is computed on prescaled ticks (the decoder passes the effective tick length)
+        HT600_INLINE bool isGlitch(const uint32_t delta, const uint8_t) const { return delta < _noise_filter_tick; }
+
+    protected:
+        uint16_t _noise_filter_tick;
+};
+
+// De-glitch filter with a compile-time threshold (Clock must be the same of the timing policy)
+template <uint16_t NOISE_FILTER_US, class Clock = HT600TickClock<1>>
+class HT600FixedFilter : public HT600NoCompensation {
+    public:
+        void configure(const uint16_t, const float) {}
+
+        static HT600_INLINE bool isGlitch(const uint32_t delta, const uint8_t shift) {
+            return delta < (uint32_t(NOISE_FILTER_US / Clock::tickLengthUs()) >> shift);
+        }
+};
+
+// No de-glitch filter: every transition reaches the decoder
+class HT600NoFilter : public HT600NoCompensation {
+    public:
+        void configure(const uint16_t, const float) {}
+
+        static HT600_INLINE bool isGlitch(const uint32_t, const uint8_t) { return false; }
+};
+
+/**
+ * @brief Rise/fall asymmetry compensation on top of a de-glitch filter.
+ * Cheap OOK receivers stretch the HIGH pulses and shrink the LOW ones (or the opposite) by a constant
+ * bias 'b', and the ISR latency adds its own: a symbol is received as L - b / H + b.
+ * Since L + H = 3T for both symbols, each decoded symbol gives a sample of the bias:
+ * - SYMBOL0 (L = T,  H = 2T): b = (H - 2L) / 3
+ * - SYMBOL1 (L = 2T, H = T):  b = (2H - L) / 3
+ * The samples (SYNC bits included) are averaged (1/4 weight) and every pair is corrected to L + b / H - b
+ * before classification, so the pulses stay centered in their windows and a tighter tolerance can be used.
+ * @tparam PERSISTENT true: the estimate is kept across frames (the next frame is corrected from the first symbol).
+ * false: the estimate restarts at every pilot (e.g., several transmitters with different bias).
+ * @tparam GlitchFilter The de-glitch filter to use (HT600RuntimeFilter, HT600FixedFilter<...> or HT600NoFilter).
+ */
+template <bool PERSISTENT = true, class GlitchFilter = HT600RuntimeFilter>
+class HT600CompensatingFilter : public GlitchFilter {
+    public:
+        HT600_INLINE void restart() {
+            if (!PERSISTENT) _bias_x3 = 0;
+        }
+
+        HT600_INLINE void correct(uint16_t &period_L, uint16_t &period_H) const {
+            int32_t bias = getBias();
+            int32_t L = int32_t(period_L) + bias;
+            int32_t H = int32_t(period_H) - bias;
+            period_L = (L < 0) ? 0 : (L > 0xFFFF) ? 0xFFFF : uint16_t(L);
+            period_H = (H < 0) ? 0 : (H > 0xFFFF) ? 0xFFFF : uint16_t(H);
+        }
+
+        HT600_INLINE void learn(const uint16_t period_L, const uint16_t period_H, const bool symbol) {
+            // Sample of 3 * bias (no division in the ISR)
+            int32_t sample_x3 = symbol ? (2 * int32_t(period_H) - int32_t(period_L)) : (int32_t(period_H) - 2 * int32_t(period_L));
+            int16_t bias_x3 = _bias_x3;
+            _bias_x3 = bias_x3 + int16_t((sample_x3 - bias_x3) / 4);
+        }
+
+        // Current estimate of the HIGH stretch (negative: LOW stretch) in ticks
+        int16_t getBias() const { return int16_t((int32_t(_bias_x3) * 85) >> 8); } // x / 3 ~= x * 85 / 256
+
+        void save(HT600Checkpoint &checkpoint) const { checkpoint.bias_x3 = _bias_x3; }
+        void restore(const HT600Checkpoint &checkpoint) { _bias_x3 = checkpoint.bias_x3; }
+
+    protected:
+        volatile int16_t _bias_x3 = 0;
+};
+
+
+// ------------------------------------------------------------------------------------------------
+// STATE POLICIES
+// ------------------------------------------------------------------------------------------------
+
+// One field per FSM variable (default)
+class HT600WideState {
+    public:
+        typedef uint32_t tick_type;
+
+        HT600_INLINE HT600_STATE state() const { return _state; }
+        HT600_INLINE uint8_t bitIndex() const { return _bit_index; }
+        HT600_INLINE bool halfSymbolRead() const { return _half_symbol_read; }
+        HT600_INLINE bool lastSymbol() const { return _last_symbol; }
+        HT600_INLINE uint16_t periodL() const { return _period_L; }
+
+        // Ticks elapsed since the last accepted transition, prescaled by the timing policy.
+        // Difference of the prescaled timestamps, as HT600CompactState, so that both states round the same way.
+        // The prescaled counter wraps at 2^(32 - shift): the mask keeps the difference right across the wrap.
+        HT600_INLINE tick_type elapsed(const uint32_t now, const uint8_t shift) const {
+            return ((now >> shift) - (_last_interrupt_tick >> shift)) & (0xFFFFFFFFUL >> shift);
+        }
+        HT600_INLINE void stamp(const uint32_t now, const uint8_t) { _last_interrupt_tick = now; }
+
+        HT600_INLINE void setPeriodL(const uint16_t period) { _period_L = period; }
+        HT600_INLINE void setHalfSymbol(const bool symbol) { _half_symbol_read = true; _last_symbol = symbol; }
+        HT600_INLINE void clearHalfSymbol() { _half_symbol_read = false; }
+        HT600_INLINE void nextBit() { _bit_index = _bit_index + 1; }
+        HT600_INLINE void setDone() { _state = HT600_STATE::DONE; }
+
+        // Pilot found: start reading the SYNC bits
+        HT600_INLINE void startFrame() {
+            _state = HT600_STATE::READING;
+            _bit_index = 0;
+            _half_symbol_read = false;
+        }
+
+        HT600_INLINE void clear() {
+            release();
+            _last_interrupt_tick = 0;
+        }
+
+        // Back to IDLE, keeping the timestamp of the last transition
+        HT600_INLINE void release() {
+            _state = HT600_STATE::IDLE;
+            _bit_index = 0;
+            _half_symbol_read = false;
+            _last_symbol = false;
+            _period_L = 0;
+        }
+
+        void save(HT600Checkpoint &checkpoint) const {
+            checkpoint.state = _state;
+            checkpoint.bit_index = _bit_index;
+            checkpoint.half_symbol_read = _half_symbol_read;
+            checkpoint.last_symbol = _last_symbol;
+            checkpoint.no_timestamp = false;
+            checkpoint.last_tick = _last_interrupt_tick;
+            checkpoint.period_L = _period_L;
+        }
+
+        void restore(const HT600Checkpoint &checkpoint) {
+            _state = checkpoint.state;
+            _bit_index = checkpoint.bit_index;
+            _half_symbol_read = checkpoint.half_symbol_read;
+            _last_symbol = checkpoint.last_symbol;
+            _last_interrupt_tick = checkpoint.last_tick;
+            _period_L = checkpoint.period_L;
+        }
+
+    protected:
+        HT600_STATE _state = HT600_STATE::IDLE;
+
+        volatile uint8_t _bit_index = 0; // Index of the current bit being read (0-19)
+        volatile bool _half_symbol_read = false; // Flag to indicate if we have read the first half of the symbol 
+        volatile bool _last_symbol = false;
+
+        volatile uint32_t _last_interrupt_tick = 0; // Last time the interrupt was called
+        volatile uint16_t _period_L = 0; // Duration of the last LOW period in ticks
+};
+
+/**
+ * @brief All the FSM variables in 5 bytes.
+ * - Status byte: bit 0-4 bit index (0-19 READING, 20 DONE, 31 IDLE), bit 5 half symbol read, bit 6 last symbol,
+ *   bit 7 no timestamp yet (after a reset the first delta saturates, as with HT600WideState).
+ * - Last transition timestamp (already prescaled) truncated to 16 bits: the decoder
+ *   only needs deltas up to the pilot window.
+ *   A silence longer than 65535 ticks wraps around; a wrapped delta can only pass the pilot check
+ *   if it falls inside the pilot window, and the frame is still validated by the SYNC bits.
+ */
+class HT600CompactState {
+    public:
+        typedef uint16_t tick_type;
+
+        HT600_INLINE HT600_STATE state() const {
+            uint8_t index = _status & INDEX_MASK;
+            if (index == INDEX_IDLE) return HT600_STATE::IDLE;
+            return (index >= INDEX_DONE) ? HT600_STATE::DONE : HT600_STATE::READING;
+        }
+        HT600_INLINE uint8_t bitIndex() const { return _status & INDEX_MASK; }
+        HT600_INLINE bool halfSymbolRead() const { return _status & HALF_SYMBOL_READ; }
+        HT600_INLINE bool lastSymbol() const { return _status & LAST_SYMBOL; }
+        HT600_INLINE uint16_t periodL() const { return _period_L; }
+
+        HT600_INLINE tick_type elapsed(const uint32_t now, const uint8_t shift) const {
+            if (_status & NO_TIMESTAMP) return 0xFFFF;
+            return uint16_t(now >> shift) - _last_interrupt_tick;
+        }
+        HT600_INLINE void stamp(const uint32_t now, const uint8_t shift) {
+            _last_interrupt_tick = uint16_t(now >> shift);
+            _status = _status & ~NO_TIMESTAMP;
+        }
+
+        HT600_INLINE void setPeriodL(const uint16_t period) { _period_L = period; }
+        HT600_INLINE void setHalfSymbol(const bool symbol) {
+            _status = (_status & INDEX_MASK) | HALF_SYMBOL_READ | (symbol ? LAST_SYMBOL : 0);
+        }
+        HT600_INLINE void clearHalfSymbol() { _status = _status & ~HALF_SYMBOL_READ; }
+        HT600_INLINE void nextBit() { _status = _status + 1; } // The index is in the low bits and never overflows (max 20)
+        HT600_INLINE void setDone() {} // Bit index 20 already means DONE
+
+        HT600_INLINE void startFrame() { _status = 0; } // Always after stamp(): NO_TIMESTAMP is already clear
+
+        HT600_INLINE void clear() {
+            _status = INDEX_IDLE | NO_TIMESTAMP;
+            _last_interrupt_tick = 0;
+            _period_L = 0;
+        }
+
+        // Back to IDLE, keeping the timestamp of the last transition
+        HT600_INLINE void release() {
+            _status = INDEX_IDLE | (_status & NO_TIMESTAMP);
+            _period_L = 0;
+        }
+
+        void save(HT600Checkpoint &checkpoint) const {
+            uint8_t status = _status;
+            checkpoint.state = state();
+            checkpoint.bit_index = (checkpoint.state == HT600_STATE::IDLE) ? 0 : (status & INDEX_MASK);
+            checkpoint.half_symbol_read = status & HALF_SYMBOL_READ;
+            checkpoint.last_symbol = status & LAST_SYMBOL;
+            checkpoint.no_timestamp = status & NO_TIMESTAMP;
+            checkpoint.last_tick = _last_interrupt_tick;
+            checkpoint.period_L = _period_L;
+        }
+
+        void restore(const HT600Checkpoint &checkpoint) {
+            uint8_t index = (checkpoint.state == HT600_STATE::IDLE) ? INDEX_IDLE :
+                            (checkpoint.state == HT600_STATE::DONE) ? INDEX_DONE : checkpoint.bit_index;
+            _status = index | (checkpoint.half_symbol_read ? HALF_SYMBOL_READ : 0) |
+                      (checkpoint.last_symbol ? LAST_SYMBOL : 0) | (checkpoint.no_timestamp ? NO_TIMESTAMP : 0);
+            _last_interrupt_tick = uint16_t(checkpoint.last_tick);
+            _period_L = checkpoint.period_L;
+        }
+
+    protected:
+        static const uint8_t INDEX_MASK       = 0x1F;
+        static const uint8_t INDEX_DONE       = 20;
+        static const uint8_t INDEX_IDLE       = 0x1F;
+        static const uint8_t HALF_SYMBOL_READ = 0x20;
+        static const uint8_t LAST_SYMBOL      = 0x40;
+        static const uint8_t NO_TIMESTAMP     = 0x80;
+
+        volatile uint16_t _last_interrupt_tick = 0; // Last time the interrupt was called (low 16 bits)
+        volatile uint16_t _period_L = 0; // Duration of the last LOW period in ticks
+        volatile uint8_t _status = INDEX_IDLE | NO_TIMESTAMP;
+};
+
+#endif
@@ -0,0 +1,211 @@
+#ifndef HT600_RANGES_H
+#define HT600_RANGES_H
+
+/**
+ * @section RANGES
+ * Lazy C++20 pipeline over edge and frame streams (host builds only):
+ *
+ *   for (HT600Frame f : edges | ht600::glitch_filter(50)
+ *                             | ht600::decode(HT600(HT680_330K_FOSC, 0.3f, 1, 50))
+ *                             | ht600::dedupe(300000)
+ *                             | ht600::only(whitelist)) { ... }
+ *
+ * - edges: any input range of HT600Edge (vector, mmap'd file, generator view...).
+ * - glitch_filter(min_ticks): drops edges closer than min_ticks to the last kept one (same rule as the
+ *   de-glitch filter policies).
+ * - decode(decoder): runs a copy of the given decoder (any composition, so the very same FSM as
+ *   handleInterrupt()) and yields an HT600Frame per complete frame.
+ * - dedupe(window_ticks): drops a frame identical to the previous one received less than window_ticks
+ *   before (a held button repeats its frame).
+ * - only(whitelist): keeps the frames whose packed() value is in the whitelist range.
+ *
+ * Every stage is a single-pass view that pulls one element at a time from the previous one:
+ * no allocation and no intermediate container, the whole pipeline runs as one loop.
+ */
+
+#if __cplusplus < 202002L || defined(ARDUINO)
+  #error "HT600Ranges.h requires C++20 (host builds only)"
+#endif
+
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <utility>
+#include "HT600.h"
+
+namespace ht600 {
+
+/**
+ * @brief Input view applying a stage to each element of V.
+ * Stage::push(element) returns an std::optional of the output: empty when the element is consumed
+ * without output (glitch, edge in the middle of a frame, duplicate...).
+ */
+template <std::ranges::input_range V, class Stage>
+    requires std::ranges::view<V>
+class stage_view : public std::ranges::view_interface<stage_view<V, Stage>> {
+    public:
+        using value_type = typename Stage::output_type;
+
+        stage_view(V base, Stage stage) : _base(std::move(base)), _stage(std::move(stage)) {}
+
+        class iterator {
+            public:
+                using value_type = stage_view::value_type;
+                using difference_type = std::ptrdiff_t;
+                using iterator_concept = std::input_iterator_tag;
+
+                iterator() = default;
+                explicit iterator(stage_view *parent) : _parent(parent), _it(std::ranges::begin(parent -> _base)) { next(); }
+
+                const value_type &operator*() const { return *_current; }
+                iterator &operator++() { next(); return *this; }
+                void operator++(int) { next(); }
+
+                friend bool operator==(const iterator &it, std::default_sentinel_t) { return !it._current; }
+
+            private:
+                void next() {
+                    _current.reset();
+                    while (_it != std::ranges::end(_parent -> _base)) {
+                        _current = _parent -> _stage.push(*_it);
+                        ++_it;
+                        if (_current) return;
+                    }
+                }
+
+                stage_view *_parent = nullptr;
+                std::ranges::iterator_t<V> _it;
+                std::optional<value_type> _current;
+        };
+
+        // Single pass: begin() may be called once
+        iterator begin() { return iterator(this); }
+        std::default_sentinel_t end() const { return std::default_sentinel; }
+
+        V base() const & requires std::copy_constructible<V> { return _base; }
+
+    private:
+        V _base;
+        Stage _stage;
+};
+
+// Range adaptor closure: range | stage_closure<Stage>{...}
+template <class Stage>
+struct stage_closure {
+    Stage stage;
+
+    template <std::ranges::viewable_range R>
+    friend auto operator|(R &&range, stage_closure closure) {
+        return stage_view<std::views::all_t<R>, Stage>(std::views::all(std::forward<R>(range)), std::move(closure.stage));
+    }
+};
+
+
+// ------------------------------------------------------------------------------------------------
+// STAGES
+// ------------------------------------------------------------------------------------------------
+
+class glitch_stage {
+    public:
+        using output_type = HT600Edge;
+
+        explicit glitch_stage(const uint32_t min_ticks) : _min_ticks(min_ticks) {}
+
+        std::optional<HT600Edge> push(const HT600Edge &edge) {
+            if (_has_last && edge.ticks - _last_ticks < _min_ticks) return std::nullopt;
+            _has_last = true;
+            _last_ticks = edge.ticks;
+            return edge;
+        }
+
+    private:
+        uint32_t _min_ticks;
+        uint32_t _last_ticks = 0;
+        bool _has_last = false;
+};
+
+template <class Decoder>
+class decode_stage {
+    public:
+        using output_type = HT600Frame;
+
+        explicit decode_stage(Decoder decoder) : _decoder(std::move(decoder)) {}
+
+        std::optional<HT600Frame> push(const HT600Edge &edge) {
+            _decoder.handleInterrupt(edge.level, edge.ticks);
+            if (!_decoder.available()) return std::nullopt;
+            HT600Frame frame = {edge.ticks, _decoder.getReceivedValue(0), _decoder.getTristateValue(1)};
+            _decoder.releaseFrame(); // Keeps the timestamp: the next copy of a held button is decoded too
+            return frame;
+        }
+
+    private:
+        Decoder _decoder;
+};
+
+class dedupe_stage {
+    public:
+        using output_type = HT600Frame;
+
+        explicit dedupe_stage(const uint32_t window_ticks) : _window_ticks(window_ticks) {}
+
+        std::optional<HT600Frame> push(const HT600Frame &frame) {
+            bool repeat = _has_last && frame.packed() == _last.packed() && frame.ticks - _last.ticks < _window_ticks;
+            // The window restarts at every repetition, so a held button gives one frame
+            _has_last = true;
+            _last = frame;
+            if (repeat) return std::nullopt;
+            return frame;
+        }
+
+    private:
+        uint32_t _window_ticks;
+        HT600Frame _last = {0, 0, 0};
+        bool _has_last = false;
+};
+
+template <std::ranges::view W>
+class only_stage {
+    public:
+        using output_type = HT600Frame;
+
+        explicit only_stage(W whitelist) : _whitelist(std::move(whitelist)) {}
+
+        std::optional<HT600Frame> push(const HT600Frame &frame) {
+            if (std::ranges::find(_whitelist, frame.packed()) == std::ranges::end(_whitelist)) return std::nullopt;
+            return frame;
+        }
+
+    private:
+        W _whitelist;
+};
+
+
+// ------------------------------------------------------------------------------------------------
+// ADAPTORS
+// ------------------------------------------------------------------------------------------------
+
+inline stage_closure<glitch_stage> glitch_filter(const uint32_t min_ticks) {
+    return {glitch_stage(min_ticks)};
+}
+
+// Takes a configured decoder by value: each pipeline decodes with its own copy
+template <class Decoder>
+stage_closure<decode_stage<Decoder>> decode(Decoder decoder) {
+    return {decode_stage<Decoder>(std::move(decoder))};
+}
+
+inline stage_closure<dedupe_stage> dedupe(const uint32_t window_ticks) {
+    return {dedupe_stage(window_ticks)};
+}
+
+// Whitelist of packed() values: a container is referenced (it must outlive the pipeline), a view is copied
+template <std::ranges::viewable_range R>
+stage_closure<only_stage<std::views::all_t<R>>> only(R &&whitelist) {
+    return {only_stage<std::views::all_t<R>>(std::views::all(std::forward<R>(whitelist)))};
+}
+
+} // namespace ht600
+
+#endif
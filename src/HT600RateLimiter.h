@@ -0,0 +1,141 @@
+#ifndef HT600_RATE_LIMITER_H
+#define HT600_RATE_LIMITER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @section RATE LIMITER
+ * Token bucket per transmitter address, checked once per decoded frame (after available()), so that a
+ * stuck button or a replayed code cannot flood the application at the encoder repeat rate.
+ *
+ * Every address starts with BURST tokens and earns one token every REFILL_MS. A frame spends a token;
+ * without tokens it is not forwarded:
+ * - COALESCE: same frame (address and data) as the last one forwarded for this address, i.e. a repeat
+ *             that the application already has (e.g. keep a "held" state alive without queuing it).
+ * - DROP:     a different frame over the rate (e.g. someone cycling codes on a known address).
+ *
+ * The table is a fixed array of 2^SLOT_BITS buckets indexed by a hash of the address, with at most
+ * PROBES slots visited per frame: constant time and bounded memory. When the probed slots are all taken
+ * by other addresses, the least recently seen one is recycled (that address starts again with a full bucket).
+ */
+
+enum class HT600_RATE : uint8_t {
+    PASS,     // Forward the frame
+    COALESCE, // Over the rate, same as the last frame forwarded for this address
+    DROP      // Over the rate, different frame
+};
+
+/**
+ * @brief Per-address token buckets in a fixed hash table.
+ * @tparam SLOT_BITS 2^SLOT_BITS addresses tracked at once (16 bytes each).
+ * @tparam PROBES Slots visited per frame before recycling one.
+ */
+template <uint8_t SLOT_BITS = 3, uint8_t PROBES = 4>
+class HT600RateLimiter {
+    public:
+        /**
+         * @param address_mask Address trits (e.g., HT600_ADDRESS_MASK): frames are grouped by these trits only.
+         * @param burst Frames forwarded back to back before limiting (1-255).
+         * @param refill_ms Time to earn one more frame (e.g., 300ms: about one frame per button press).
+         */
+        HT600RateLimiter(const uint16_t address_mask, const uint8_t burst, const uint16_t refill_ms)
+            : _address_mask((uint32_t(address_mask) << 16) | address_mask), _refill_ms(refill_ms), _burst(burst) {
+            clear();
+        }
+
+        /**
+         * @brief Spends a token of the frame's address.
+         * @param packed The whole frame: (getTristateValue(1) << 16) | getReceivedValue(0) or HT600Frame::packed().
+         * @param now_ms Current time (e.g., millis()), wrapping around is fine.
+         */
+        HT600_RATE check(const uint32_t packed, const uint32_t now_ms) {
+            uint32_t address = packed & _address_mask;
+            Slot &slot = find(address, now_ms);
+
+            // Refill, keeping the remainder so that the rate is exact
+            uint32_t elapsed = now_ms - slot.refill_ms;
+            if (elapsed >= _refill_ms) {
+                uint32_t earned = elapsed / _refill_ms;
+                if (earned >= uint32_t(_burst - slot.tokens)) {
+                    slot.tokens = _burst;
+                    slot.refill_ms = now_ms;
+                } else {
+                    slot.tokens += uint8_t(earned);
+                    slot.refill_ms += earned * _refill_ms;
+                }
+            }
+            slot.seen_ms = now_ms;
+
+            if (slot.tokens > 0) {
+                slot.tokens--;
+                slot.frame = packed;
+                return HT600_RATE::PASS;
+            }
+            if (slot.frame == packed) {
+                _coalesce_count++;
+                return HT600_RATE::COALESCE;
+            }
+            _drop_count++;
+            return HT600_RATE::DROP;
+        }
+
+        void clear() {
+            for (uint16_t i = 0; i < SLOTS; i++) _slots[i].used = false;
+            _coalesce_count = 0;
+            _drop_count = 0;
+        }
+
+        uint16_t getCoalesceCount() const { return _coalesce_count; } // Repeats folded since clear()
+        uint16_t getDropCount() const { return _drop_count; }         // Frames dropped since clear()
+
+    protected:
+        static const uint16_t SLOTS = uint16_t(1) << SLOT_BITS;
+
+        struct Slot {
+            uint32_t frame;     // Last frame forwarded (its address trits are the key)
+            uint32_t refill_ms; // Time of the last token earned
+            uint32_t seen_ms;   // Time of the last frame, for recycling
+            uint8_t tokens;
+            bool used;
+        };
+
+        // Slot of the address, or a new one: first free slot, else the least recently seen of the probes
+        Slot &find(const uint32_t address, const uint32_t now_ms) {
+            uint16_t index = uint16_t((address * 2654435761UL) >> (32 - SLOT_BITS)) & (SLOTS - 1);
+            Slot *candidate = nullptr;
+            uint32_t oldest_age = 0;
+
+            for (uint8_t p = 0; p < PROBES && p < SLOTS; p++) {
+                Slot &slot = _slots[(index + p) & (SLOTS - 1)];
+                if (!slot.used) {
+                    if (!candidate || candidate -> used) candidate = &slot;
+                    continue;
+                }
+                if ((slot.frame & _address_mask) == address) return slot;
+                uint32_t age = now_ms - slot.seen_ms;
+                if (!candidate || (candidate -> used && age >= oldest_age)) {
+                    candidate = &slot;
+                    oldest_age = age;
+                }
+            }
+
+            candidate -> used = true;
+            candidate -> frame = address; // No frame forwarded yet: its data trits are cleared
+            candidate -> refill_ms = now_ms;
+            candidate -> tokens = _burst;
+            return *candidate;
+        }
+
+        Slot _slots[SLOTS];
+        uint32_t _address_mask; // Address trits in both halves of the packed frame
+        uint16_t _refill_ms;
+        uint16_t _coalesce_count;
+        uint16_t _drop_count;
+        uint8_t _burst;
+
+        static_assert(SLOT_BITS >= 1 && SLOT_BITS <= 12, "HT600RateLimiter: SLOT_BITS must be 1 to 12");
+        static_assert(PROBES >= 1, "HT600RateLimiter: PROBES must be at least 1");
+};
+
+#endif
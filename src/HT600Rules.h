@@ -0,0 +1,211 @@
+#ifndef HT600_RULES_H
+#define HT600_RULES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @section RULES
+ * Maps received codes to actions with trinary patterns, e.g. "01Z1Z0110" (address 01Z1Z0110, any data).
+ *
+ * A pattern is compiled once into a (value, care) pair over HT600Frame::packed() (Z mask in the high
+ * half, value in the low half): '0' cares about the HL and Z bits of its trit and expects 0/0,
+ * '1' expects HL = 1 / Z = 0, 'Z' expects HL = 0 / Z = 1. A frame matches a rule when
+ *
+ *     ((packed ^ value) & care) == 0
+ *
+ * so each rule costs one XOR, one AND and one compare, whatever its number of wildcards.
+ *
+ * The rules are grouped by a one-level decision tree: build() picks up to INDEX_BITS bits of the packed
+ * frame that split the rule set most evenly, and sorts the rules into 2^INDEX_BITS buckets by their
+ * value on those bits (rules with a wildcard on one of them go to a shared list). A frame only tests
+ * its own bucket and the shared list, in insertion order.
+ * Storage is fixed (no heap): on AVR keep CAPACITY and INDEX_BITS small (e.g. 16 rules, 3 index bits).
+ */
+
+/**
+ * @brief Compiles a trinary pattern into a (value, care) pair over HT600Frame::packed().
+ * The first character is the first data trit (bit 0 of getReceivedValue()), up to 16 trits:
+ * '0', '1', 'Z'/'z', and '?', '*', 'X'/'x' for any trit. Spaces, '_' and '-' are skipped,
+ * missing trailing trits are wildcards.
+ * @return false on an unknown character or more than 16 trits.
+ */
+inline bool HT600_parsePattern(const char *pattern, uint32_t &value, uint32_t &care) {
+    value = 0;
+    care = 0;
+    uint8_t trit = 0;
+
+    for (; *pattern; pattern++) {
+        char c = *pattern;
+        if (c == ' ' || c == '_' || c == '-') continue;
+        if (trit >= 16) return false;
+
+        uint32_t hl_bit = uint32_t(1) << trit;
+        uint32_t z_bit  = uint32_t(1) << (trit + 16);
+        if (c == '0') {
+            care |= hl_bit | z_bit;
+        } else if (c == '1') {
+            care |= hl_bit | z_bit;
+            value |= hl_bit;
+        } else if (c == 'Z' || c == 'z') {
+            care |= hl_bit | z_bit;
+            value |= z_bit;
+        } else if (c != '?' && c != '*' && c != 'X' && c != 'x') {
+            return false;
+        }
+        trit++;
+    }
+    return true;
+}
+
+/**
+ * @brief Fixed-capacity rule set.
+ * @tparam CAPACITY Maximum number of rules.
+ * @tparam INDEX_BITS Bits of the packed frame used to select a bucket (0: a single list).
+ */
+template <uint16_t CAPACITY, uint8_t INDEX_BITS = 4>
+class HT600RuleSet {
+    public:
+        /**
+         * @brief Adds a rule (call build() once all the rules are added).
+         * @return false if the set is full or the pattern is invalid.
+         */
+        bool add(const char *pattern, const uint16_t action) {
+            uint32_t value, care;
+            if (!HT600_parsePattern(pattern, value, care)) return false;
+            return add(value, care, action);
+        }
+
+        bool add(const uint32_t value, const uint32_t care, const uint16_t action) {
+            if (_size >= CAPACITY) return false;
+            _value[_size] = value & care;
+            _care[_size] = care;
+            _action[_size] = action;
+            _size++;
+            _built = false;
+            return true;
+        }
+
+        void clear() {
+            _size = 0;
+            _built = false;
+        }
+
+        uint16_t size() const { return _size; }
+
+        /**
+         * @brief Chooses the index bits and sorts the rules into their buckets (O(rules * 32)).
+         */
+        void build() {
+            // Score of each bit: the smaller side of the split among the rules that care about it
+            uint16_t ones[32], zeros[32];
+            for (uint8_t b = 0; b < 32; b++) ones[b] = zeros[b] = 0;
+            for (uint16_t r = 0; r < _size; r++) {
+                for (uint8_t b = 0; b < 32; b++) {
+                    if (!(_care[r] >> b & 1)) continue;
+                    if (_value[r] >> b & 1) ones[b]++;
+                    else zeros[b]++;
+                }
+            }
+
+            _index_mask = 0;
+            _index_count = 0;
+            while (_index_count < INDEX_BITS) {
+                int8_t best = -1;
+                uint16_t best_score = 0;
+                for (uint8_t b = 0; b < 32; b++) {
+                    uint16_t score = (ones[b] < zeros[b]) ? ones[b] : zeros[b];
+                    if (!(_index_mask >> b & 1) && score > best_score) {
+                        best = b;
+                        best_score = score;
+                    }
+                }
+                if (best < 0) break; // No other bit splits the rules
+                _index_mask |= uint32_t(1) << best;
+                _index_bit[_index_count++] = best;
+            }
+
+            // Counting sort by bucket (stable: insertion order is kept inside each bucket)
+            for (uint16_t k = 0; k <= BUCKETS + 1; k++) _start[k] = 0;
+            for (uint16_t r = 0; r < _size; r++) _start[bucketOf(r) + 1]++;
+            for (uint16_t k = 0; k <= BUCKETS; k++) _start[k + 1] += _start[k];
+            uint16_t fill[BUCKETS + 1];
+            for (uint16_t k = 0; k <= BUCKETS; k++) fill[k] = _start[k];
+            for (uint16_t r = 0; r < _size; r++) _order[fill[bucketOf(r)]++] = r;
+
+            _built = true;
+        }
+
+        /**
+         * @brief First matching rule, in insertion order.
+         * @param packed HT600Frame::packed() (or (getTristateValue(1) << 16) | getReceivedValue(0)).
+         * @param action Out: action of the matching rule.
+         * @return false if no rule matches (or build() was not called after the last add()).
+         */
+        bool match(const uint32_t packed, uint16_t &action) const {
+            bool found = false;
+            forEachMatch(packed, [&](const uint16_t a) {
+                action = a;
+                found = true;
+                return false; // Stop at the first one
+            });
+            return found;
+        }
+
+        /**
+         * @brief Calls callback(action) for every matching rule, in insertion order, until it returns false.
+         * @return The number of matching rules reported.
+         */
+        template <class Callback>
+        uint16_t forEachMatch(const uint32_t packed, Callback callback) const {
+            if (!_built) return 0;
+
+            // Merge the frame's bucket with the shared list, both sorted by rule index
+            uint16_t bucket = keyOf(packed);
+            uint16_t i = _start[bucket], i_end = _start[bucket + 1];
+            uint16_t j = _start[BUCKETS], j_end = _start[BUCKETS + 1];
+            uint16_t count = 0;
+
+            while (i < i_end || j < j_end) {
+                uint16_t r;
+                if (j >= j_end || (i < i_end && _order[i] < _order[j])) r = _order[i++];
+                else r = _order[j++];
+
+                if (((packed ^ _value[r]) & _care[r]) == 0) {
+                    count++;
+                    if (!callback(_action[r])) break;
+                }
+            }
+            return count;
+        }
+
+    protected:
+        static const uint16_t BUCKETS = uint16_t(1) << INDEX_BITS; // Bucket BUCKETS is the shared list
+
+        // Gathers the index bits of a packed frame
+        uint16_t keyOf(const uint32_t packed) const {
+            uint16_t key = 0;
+            for (uint8_t k = 0; k < _index_count; k++) key |= uint16_t(packed >> _index_bit[k] & 1) << k;
+            return key;
+        }
+
+        uint16_t bucketOf(const uint16_t rule) const {
+            if ((_care[rule] & _index_mask) != _index_mask) return BUCKETS;
+            return keyOf(_value[rule]);
+        }
+
+        uint32_t _value[CAPACITY];
+        uint32_t _care[CAPACITY];
+        uint16_t _action[CAPACITY];
+        uint16_t _order[CAPACITY];        // Rule indices sorted by bucket
+        uint16_t _start[BUCKETS + 2];     // Bucket k is _order[_start[k]] .. _order[_start[k + 1] - 1]
+        uint8_t _index_bit[INDEX_BITS > 0 ? INDEX_BITS : 1];
+        uint32_t _index_mask = 0;
+        uint16_t _size = 0;
+        uint8_t _index_count = 0;
+        bool _built = false;
+
+        static_assert(INDEX_BITS <= 12, "HT600RuleSet: INDEX_BITS must be 12 or less");
+};
+
+#endif
@@ -0,0 +1,373 @@
+#ifndef HT600_STORE_H
+#define HT600_STORE_H
+
+/**
+ * @section STORE
+ * Append-only, time-indexed history of decoded frames on disk (POSIX hosts only), for audits over
+ * months of traffic: "all the frames of address X last week" reads a few blocks instead of the whole
+ * history.
+ *
+ * File layout (native byte order):
+ *   header   64 bytes: magic, version, address mask, records per block
+ *   block 0  block header + one column per field
+ *   block 1  ...
+ * Every block holds HT600_STORE_BLOCK_RECORDS records stored column by column (time, value, Z mask,
+ * confidence, source), so a query only touches the columns it tests. Its header keeps:
+ * - the record count,
+ * - the min/max time of its records: a time range skips every block outside it,
+ * - a bitmap of the addresses in the block (HT600_STORE_BITMAP_BITS bits, one per address hash):
+ *   an address query skips every block where the bit of its address is clear.
+ *
+ * The writer appends records to the last block. flush() writes the records appended since the previous
+ * flush (a few bytes per column) and the block header, then syncs: a record is on disk once flush()
+ * returns, a crash loses at most the records appended since.
+ * The reader maps the whole file read-only and builds a time index of the blocks: the running maximum
+ * of max_time and the minimum of min_time over the following blocks. Both are sorted whatever the
+ * order of the times, so a time range binary-searches its first and last blocks. Times need not be
+ * sorted, the index only gets less selective. Open the file again to see the blocks appended since.
+ */
+
+#if defined(ARDUINO) || !(defined(__unix__) || defined(__APPLE__))
+  #error "HT600Store.h requires a POSIX host (mmap)"
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HT600_STORE_MAGIC          0x3153463030365448ULL // "HT600FS1"
+#define HT600_STORE_VERSION        1
+#define HT600_STORE_BLOCK_RECORDS  4096
+#define HT600_STORE_BITMAP_LOG2    12   // 4096 bits (512 bytes) per block: selective up to a few hundred addresses per block
+#define HT600_STORE_BITMAP_BITS    (1 << HT600_STORE_BITMAP_LOG2)
+
+// A stored frame
+struct HT600Record {
+    int64_t time_ms;    // Reception time (e.g., Unix time in ms)
+    uint16_t value;     // HT600Frame::value
+    uint16_t z_mask;    // HT600Frame::z_mask
+    uint8_t confidence; // Set by the application (e.g., number of gateways that heard the frame)
+    uint8_t source;     // Gateway or receiver
+
+    uint32_t packed() const { return (uint32_t(z_mask) << 16) | value; }
+};
+
+struct HT600StoreHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t address_mask;  // HT600Frame::packed() layout
+    uint32_t block_records;
+    uint32_t reserved[11];
+};
+
+struct HT600StoreBlock {
+    uint32_t count;
+    uint32_t reserved;
+    int64_t min_time;
+    int64_t max_time;
+    uint64_t bitmap[HT600_STORE_BITMAP_BITS / 64];
+    int64_t time[HT600_STORE_BLOCK_RECORDS];
+    uint16_t value[HT600_STORE_BLOCK_RECORDS];
+    uint16_t z_mask[HT600_STORE_BLOCK_RECORDS];
+    uint8_t confidence[HT600_STORE_BLOCK_RECORDS];
+    uint8_t source[HT600_STORE_BLOCK_RECORDS];
+};
+
+static_assert(sizeof(HT600StoreHeader) == 64, "HT600StoreHeader is part of the file format");
+static_assert(sizeof(HT600StoreBlock) % 8 == 0, "HT600StoreBlock must keep the blocks 8-byte aligned");
+
+// Bit of an address in the block bitmaps
+inline uint16_t HT600_storeBit(const uint32_t address) {
+    return uint16_t(uint32_t(address * 2654435761UL) >> (32 - HT600_STORE_BITMAP_LOG2));
+}
+
+/**
+ * @brief Appends records to a store file (created if missing).
+ */
+class HT600StoreWriter {
+    public:
+        HT600StoreWriter() {}
+        ~HT600StoreWriter() { close(); }
+        HT600StoreWriter(const HT600StoreWriter &) = delete;
+        HT600StoreWriter &operator=(const HT600StoreWriter &) = delete;
+
+        /**
+         * @param address_mask Address trits in HT600Frame::packed() layout, e.g.
+         * (uint32_t(HT600_ADDRESS_MASK) << 16) | HT600_ADDRESS_MASK. Ignored when the file exists.
+         * @return false if the file cannot be opened or is not a store.
+         */
+        bool open(const char *path, const uint32_t address_mask) {
+            close();
+            _fd = ::open(path, O_RDWR | O_CREAT, 0644);
+            if (_fd < 0) return false;
+
+            struct stat st;
+            if (fstat(_fd, &st) < 0) return fail();
+            if (st.st_size == 0) {
+                memset(&_header, 0, sizeof(_header));
+                _header.magic = HT600_STORE_MAGIC;
+                _header.version = HT600_STORE_VERSION;
+                _header.address_mask = address_mask;
+                _header.block_records = HT600_STORE_BLOCK_RECORDS;
+                if (pwrite(_fd, &_header, sizeof(_header), 0) != ssize_t(sizeof(_header))) return fail();
+                _blocks = 0;
+                startBlock();
+                return true;
+            }
+
+            if (pread(_fd, &_header, sizeof(_header), 0) != ssize_t(sizeof(_header)) ||
+                _header.magic != HT600_STORE_MAGIC || _header.version != HT600_STORE_VERSION ||
+                _header.block_records != HT600_STORE_BLOCK_RECORDS) return fail();
+
+            // Resume the last block if it is not full
+            _blocks = uint64_t(st.st_size - sizeof(_header)) / sizeof(HT600StoreBlock);
+            if (_blocks > 0) {
+                if (pread(_fd, &_block, sizeof(_block), offsetOf(_blocks - 1)) != ssize_t(sizeof(_block))) return fail();
+                if (_block.count < HT600_STORE_BLOCK_RECORDS) {
+                    _blocks--;
+                    _flushed = _block.count;
+                    return true;
+                }
+            }
+            startBlock();
+            return true;
+        }
+
+        /**
+         * @brief Appends a record (written on flush(), or when its block is full).
+         * @return false if a full block could not be written.
+         */
+        bool append(const HT600Record &record) {
+            if (_fd < 0) return false;
+            uint32_t i = _block.count;
+            if (i == 0 || record.time_ms < _block.min_time) _block.min_time = record.time_ms;
+            if (i == 0 || record.time_ms > _block.max_time) _block.max_time = record.time_ms;
+            uint16_t bit = HT600_storeBit(record.packed() & _header.address_mask);
+            _block.bitmap[bit >> 6] |= uint64_t(1) << (bit & 63);
+            _block.time[i] = record.time_ms;
+            _block.value[i] = record.value;
+            _block.z_mask[i] = record.z_mask;
+            _block.confidence[i] = record.confidence;
+            _block.source[i] = record.source;
+            _block.count++;
+
+            if (_block.count < HT600_STORE_BLOCK_RECORDS) return true;
+            if (!flush()) return false;
+            _blocks++;
+            startBlock();
+            return true;
+        }
+
+        // Writes the records appended since the last flush and the block header (fdatasync included)
+        bool flush() {
+            if (_fd < 0) return false;
+            uint32_t from = _flushed, n = _block.count - _flushed;
+            if (n == 0) return true;
+            // First write to this block: extend the file over the whole block (sparse)
+            if (from == 0 && ftruncate(_fd, offsetOf(_blocks + 1)) < 0) return false;
+            if (!writeAt(offsetof(HT600StoreBlock, time) + from * sizeof(int64_t), &_block.time[from], n * sizeof(int64_t)) ||
+                !writeAt(offsetof(HT600StoreBlock, value) + from * sizeof(uint16_t), &_block.value[from], n * sizeof(uint16_t)) ||
+                !writeAt(offsetof(HT600StoreBlock, z_mask) + from * sizeof(uint16_t), &_block.z_mask[from], n * sizeof(uint16_t)) ||
+                !writeAt(offsetof(HT600StoreBlock, confidence) + from, &_block.confidence[from], n) ||
+                !writeAt(offsetof(HT600StoreBlock, source) + from, &_block.source[from], n) ||
+                !writeAt(0, &_block, offsetof(HT600StoreBlock, time))) return false; // Count, min/max, bitmap
+            if (fdatasync(_fd) < 0) return false;
+            _flushed = _block.count;
+            return true;
+        }
+
+        void close() {
+            if (_fd < 0) return;
+            flush();
+            ::close(_fd);
+            _fd = -1;
+        }
+
+    protected:
+        static off_t offsetOf(const uint64_t block) {
+            return off_t(sizeof(HT600StoreHeader) + block * sizeof(HT600StoreBlock));
+        }
+
+        void startBlock() {
+            memset(&_block, 0, sizeof(_block));
+            _flushed = 0;
+        }
+
+        // Writes a part of the last block
+        bool writeAt(const size_t offset, const void *data, const size_t length) {
+            return pwrite(_fd, data, length, offsetOf(_blocks) + off_t(offset)) == ssize_t(length);
+        }
+
+        bool fail() {
+            ::close(_fd);
+            _fd = -1;
+            return false;
+        }
+
+        HT600StoreHeader _header;
+        HT600StoreBlock _block; // Last block, being filled
+        uint64_t _blocks = 0;   // Full blocks before it
+        uint32_t _flushed = 0;  // Records of the last block already written
+        int _fd = -1;
+};
+
+/**
+ * @brief Read-only, memory-mapped view of a store file.
+ */
+class HT600StoreReader {
+    public:
+        HT600StoreReader() {}
+        ~HT600StoreReader() { close(); }
+        HT600StoreReader(const HT600StoreReader &) = delete;
+        HT600StoreReader &operator=(const HT600StoreReader &) = delete;
+
+        // @return false if the file cannot be mapped or is not a store
+        bool open(const char *path) {
+            close();
+            int fd = ::open(path, O_RDONLY);
+            if (fd < 0) return false;
+            struct stat st;
+            bool ok = fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(HT600StoreHeader);
+            if (ok) {
+                _size = size_t(st.st_size);
+                void *map = mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+                ok = map != MAP_FAILED;
+                if (ok) _map = static_cast<const uint8_t *>(map);
+            }
+            ::close(fd);
+            if (!ok) return false;
+
+            const HT600StoreHeader *header = reinterpret_cast<const HT600StoreHeader *>(_map);
+            if (header -> magic != HT600_STORE_MAGIC || header -> version != HT600_STORE_VERSION ||
+                header -> block_records != HT600_STORE_BLOCK_RECORDS) {
+                close();
+                return false;
+            }
+            _address_mask = header -> address_mask;
+            _blocks = (_size - sizeof(HT600StoreHeader)) / sizeof(HT600StoreBlock);
+            madvise(const_cast<uint8_t *>(_map), _size, MADV_RANDOM);
+            return index();
+        }
+
+        void close() {
+            if (_map) munmap(const_cast<uint8_t *>(_map), _size);
+            free(_max_before);
+            _map = nullptr;
+            _max_before = _min_after = nullptr;
+            _blocks = _records = 0;
+        }
+
+        uint64_t getBlockCount() const { return _blocks; }
+        uint32_t getAddressMask() const { return _address_mask; }
+
+        uint64_t size() const { return _records; }
+
+        /**
+         * @brief Calls callback(record) for every record with from_ms <= time_ms < to_ms, in file order.
+         * @return The number of records reported.
+         */
+        template <class Callback>
+        uint64_t query(const int64_t from_ms, const int64_t to_ms, Callback callback) const {
+            return scan(from_ms, to_ms, false, 0, callback);
+        }
+
+        /**
+         * @brief Same, only for the records of an address.
+         * @param address Any frame of the transmitter: only its address trits are compared.
+         */
+        template <class Callback>
+        uint64_t query(const uint32_t address, const int64_t from_ms, const int64_t to_ms, Callback callback) const {
+            return scan(from_ms, to_ms, true, address & _address_mask, callback);
+        }
+
+        uint64_t getBlocksRead() const { return _blocks_read; } // Blocks scanned by the last query (not skipped by the indexes)
+
+    protected:
+        const HT600StoreBlock &block(const uint64_t b) const {
+            return *reinterpret_cast<const HT600StoreBlock *>(_map + sizeof(HT600StoreHeader) + b * sizeof(HT600StoreBlock));
+        }
+
+        static uint32_t recordsOf(const HT600StoreBlock &blk) {
+            return blk.count < HT600_STORE_BLOCK_RECORDS ? blk.count : HT600_STORE_BLOCK_RECORDS;
+        }
+
+        // Reads every block header once: running max of max_time, min of min_time over the blocks after
+        bool index() {
+            if (_blocks == 0) return true;
+            _max_before = static_cast<int64_t *>(malloc(2 * _blocks * sizeof(int64_t)));
+            if (!_max_before) {
+                close();
+                return false;
+            }
+            _min_after = _max_before + _blocks;
+            int64_t max = INT64_MIN, min = INT64_MAX;
+            for (uint64_t b = 0; b < _blocks; b++) {
+                const HT600StoreBlock &blk = block(b);
+                if (recordsOf(blk) > 0 && blk.max_time > max) max = blk.max_time;
+                _max_before[b] = max;
+                _records += recordsOf(blk);
+            }
+            for (uint64_t b = _blocks; b-- > 0;) {
+                const HT600StoreBlock &blk = block(b);
+                if (recordsOf(blk) > 0 && blk.min_time < min) min = blk.min_time;
+                _min_after[b] = min;
+            }
+            return true;
+        }
+
+        template <class Callback>
+        uint64_t scan(const int64_t from_ms, const int64_t to_ms, const bool by_address, const uint32_t address, Callback callback) const {
+            uint16_t bit = HT600_storeBit(address);
+            uint64_t count = 0;
+            _blocks_read = 0;
+
+            // Blocks before first: all their times < from_ms. Blocks from last on: all their times >= to_ms
+            uint64_t first = 0, last = _blocks;
+            for (uint64_t high = _blocks; first < high;) {
+                uint64_t mid = first + (high - first) / 2;
+                if (_max_before[mid] < from_ms) first = mid + 1;
+                else high = mid;
+            }
+            for (uint64_t low = first; low < last;) {
+                uint64_t mid = low + (last - low) / 2;
+                if (_min_after[mid] >= to_ms) last = mid;
+                else low = mid + 1;
+            }
+
+            for (uint64_t b = first; b < last; b++) {
+                const HT600StoreBlock &blk = block(b);
+                uint32_t n = recordsOf(blk);
+                if (n == 0 || blk.max_time < from_ms || blk.min_time >= to_ms) continue;
+                if (by_address && !(blk.bitmap[bit >> 6] >> (bit & 63) & 1)) continue;
+                _blocks_read++;
+
+                for (uint32_t i = 0; i < n; i++) {
+                    int64_t t = blk.time[i];
+                    if (t < from_ms || t >= to_ms) continue;
+                    uint32_t packed = (uint32_t(blk.z_mask[i]) << 16) | blk.value[i];
+                    if (by_address && (packed & _address_mask) != address) continue;
+                    HT600Record record = {t, blk.value[i], blk.z_mask[i], blk.confidence[i], blk.source[i]};
+                    callback(record);
+                    count++;
+                }
+            }
+            return count;
+        }
+
+        const uint8_t *_map = nullptr;
+        size_t _size = 0;
+        uint64_t _blocks = 0;
+        uint64_t _records = 0;
+        int64_t *_max_before = nullptr; // Per block: max time of the blocks up to it (index() allocates both)
+        int64_t *_min_after = nullptr;  // Per block: min time of the blocks from it on
+        uint32_t _address_mask = 0;
+        mutable uint64_t _blocks_read = 0;
+};
+
+#endif
@@ -0,0 +1,212 @@
+#ifndef HT600_TRAFFIC_H
+#define HT600_TRAFFIC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @section TRAFFIC
+ * Per-address traffic statistics for gateways: frames, repeats and partial-address rejects of every
+ * transmitter, and the heaviest transmitters, in fixed memory.
+ *
+ * The counters of all the addresses share a count-min sketch: DEPTH rows of 2^WIDTH_BITS cells, one
+ * cell per row chosen by a hash of the address. An update adds to DEPTH cells, an estimate is the
+ * minimum of them: never below the true count, above it only when every row collides (the error is
+ * at most about 2.7 * total / 2^WIDTH_BITS with probability 1 - e^-DEPTH).
+ * The TOP_K addresses with the most frames are kept in a small table with their estimates, updated
+ * on every frame: an address enters it when its estimate passes the smallest entry.
+ *
+ * - Frame:  a decoded frame (onFrame()).
+ * - Repeat: a frame identical to the previous one within 'repeat_ms' (a held button, or the
+ *           encoder repeating a word): frames - repeats is about the number of presses.
+ * - Reject: a frame of this address rejected after its SYNC bits (onPartialFrame(), fed by
+ *           HT600PartialStats::takePartialFrame()). A frame cut short only carries the first trits of
+ *           its address: it is credited when they match exactly one address of the top-K table, or
+ *           when every address trit was read; otherwise it is counted as unattributed.
+ *
+ * An update costs DEPTH multiplications and a scan of the TOP_K entries: call it from loop(), at any
+ * frame rate the radio can carry.
+ */
+
+struct HT600TrafficCounts {
+    uint32_t frames;
+    uint32_t repeats;
+    uint32_t rejects;
+};
+
+struct HT600TrafficEntry {
+    uint32_t address; // Address trits of the frames (HT600Frame::packed() layout, data trits cleared)
+    HT600TrafficCounts counts;
+};
+
+/**
+ * @brief Count-min sketch of per-address counters plus a top-K table.
+ * @tparam WIDTH_BITS 2^WIDTH_BITS cells per row (12 bytes each).
+ * @tparam DEPTH Rows (independent hashes).
+ * @tparam TOP_K Heaviest addresses kept.
+ */
+template <uint8_t WIDTH_BITS = 6, uint8_t DEPTH = 4, uint8_t TOP_K = 8>
+class HT600TrafficStats {
+    public:
+        /**
+         * @param address_mask Address trits of the chip (e.g., HT600_ADDRESS_MASK).
+         * @param repeat_ms Maximum gap between two copies of the same frame (e.g., 200ms).
+         * @param min_trits Minimum number of address trits for crediting a partial frame.
+         */
+        HT600TrafficStats(const uint16_t address_mask, const uint16_t repeat_ms, const uint8_t min_trits = 4)
+            : _address_mask((uint32_t(address_mask) << 16) | address_mask), _repeat_ms(repeat_ms), _min_trits(min_trits) {
+            clear();
+        }
+
+        /**
+         * @brief Counts a decoded frame.
+         * @param packed The whole frame: (getTristateValue(1) << 16) | getReceivedValue(0) or HT600Frame::packed().
+         * @param now_ms Current time (e.g., millis()), wrapping around is fine.
+         */
+        void onFrame(const uint32_t packed, const uint32_t now_ms) {
+            bool repeat = _frame_count > 0 && packed == _last_frame && now_ms - _last_ms <= _repeat_ms;
+            _last_frame = packed;
+            _last_ms = now_ms;
+            _frame_count++;
+            if (repeat) _repeat_count++;
+            add(packed & _address_mask, 1, repeat ? 1 : 0, 0);
+        }
+
+        /**
+         * @brief Counts a frame rejected after 'trits' trits (HT600PartialStats::takePartialFrame()).
+         * @return true if it was credited to an address.
+         */
+        bool onPartialFrame(const uint32_t packed, const uint8_t trits) {
+            _reject_count++;
+            uint16_t read = uint16_t((uint32_t(1) << (trits > 16 ? 16 : trits)) - 1);
+            uint32_t read_mask = ((uint32_t(read) << 16) | read) & _address_mask;
+            uint32_t address = packed & read_mask;
+
+            if (read_mask != _address_mask) {
+                // Address incomplete: credit the only top-K address starting with these trits
+                uint8_t known = 0;
+                for (uint32_t m = read_mask; m; m &= m - 1) known++;
+                const HT600TrafficEntry *match = nullptr;
+                for (uint8_t k = 0; k < _top_size && known / 2 >= _min_trits; k++) {
+                    if ((_top[k].address & read_mask) != address) continue;
+                    if (match) {
+                        match = nullptr; // Ambiguous
+                        break;
+                    }
+                    match = &_top[k];
+                }
+                if (!match) {
+                    _unattributed_count++;
+                    return false;
+                }
+                address = match -> address;
+            }
+            add(address, 0, 0, 1);
+            return true;
+        }
+
+        /**
+         * @brief Estimated counters of an address (never below the true counts).
+         * @param address Any frame of the transmitter: its data trits are ignored.
+         */
+        HT600TrafficCounts estimate(const uint32_t address) const {
+            uint32_t key = address & _address_mask;
+            HT600TrafficCounts result = _cells[0][cellOf(key, 0)];
+            for (uint8_t d = 1; d < DEPTH; d++) {
+                const HT600TrafficCounts &cell = _cells[d][cellOf(key, d)];
+                if (cell.frames < result.frames) result.frames = cell.frames;
+                if (cell.repeats < result.repeats) result.repeats = cell.repeats;
+                if (cell.rejects < result.rejects) result.rejects = cell.rejects;
+            }
+            return result;
+        }
+
+        /**
+         * @brief Copies the heaviest addresses, most frames first.
+         * @return The number of entries written (at most TOP_K and max_entries).
+         */
+        uint8_t top(HT600TrafficEntry *entries, const uint8_t max_entries) const {
+            uint8_t count = (_top_size < max_entries) ? _top_size : max_entries;
+            bool taken[TOP_K] = {};
+            for (uint8_t i = 0; i < count; i++) {
+                uint8_t best = 0xFF;
+                for (uint8_t k = 0; k < _top_size; k++) {
+                    if (!taken[k] && (best == 0xFF || _top[k].counts.frames > _top[best].counts.frames)) best = k;
+                }
+                taken[best] = true;
+                entries[i] = _top[best];
+            }
+            return count;
+        }
+
+        void clear() {
+            for (uint8_t d = 0; d < DEPTH; d++) {
+                for (uint16_t w = 0; w < WIDTH; w++) _cells[d][w] = HT600TrafficCounts();
+            }
+            _top_size = 0;
+            _frame_count = 0;
+            _repeat_count = 0;
+            _reject_count = 0;
+            _unattributed_count = 0;
+        }
+
+        uint32_t getFrameCount() const { return _frame_count; }               // Frames counted
+        uint32_t getRepeatCount() const { return _repeat_count; }             // Of which repeats
+        uint32_t getRejectCount() const { return _reject_count; }             // Partial frames counted
+        uint32_t getUnattributedCount() const { return _unattributed_count; } // Of which not credited to an address
+
+    protected:
+        static const uint16_t WIDTH = uint16_t(1) << WIDTH_BITS;
+
+        // One multiplicative hash per row
+        static uint16_t cellOf(const uint32_t key, const uint8_t row) {
+            static const uint32_t SEEDS[8] = {2654435761UL, 2246822519UL, 3266489917UL, 668265263UL,
+                                              374761393UL, 3370259147UL, 2869860233UL, 1103515245UL};
+            uint32_t h = (key ^ (key >> 15)) * SEEDS[row & 7] + row;
+            return uint16_t(h >> (32 - WIDTH_BITS));
+        }
+
+        void add(const uint32_t address, const uint32_t frames, const uint32_t repeats, const uint32_t rejects) {
+            for (uint8_t d = 0; d < DEPTH; d++) {
+                HT600TrafficCounts &cell = _cells[d][cellOf(address, d)];
+                cell.frames += frames;
+                cell.repeats += repeats;
+                cell.rejects += rejects;
+            }
+            HT600TrafficCounts counts = estimate(address);
+
+            // Update the entry of the address, or take the place of the smallest one
+            uint8_t smallest = 0;
+            for (uint8_t k = 0; k < _top_size; k++) {
+                if (_top[k].address == address) {
+                    _top[k].counts = counts;
+                    return;
+                }
+                if (_top[k].counts.frames < _top[smallest].counts.frames) smallest = k;
+            }
+            if (_top_size < TOP_K) {
+                _top[_top_size++] = {address, counts};
+            } else if (counts.frames > _top[smallest].counts.frames) {
+                _top[smallest] = {address, counts};
+            }
+        }
+
+        HT600TrafficCounts _cells[DEPTH][WIDTH];
+        HT600TrafficEntry _top[TOP_K];
+        uint32_t _address_mask;
+        uint32_t _last_frame = 0;
+        uint32_t _last_ms = 0;
+        uint32_t _frame_count;
+        uint32_t _repeat_count;
+        uint32_t _reject_count;
+        uint32_t _unattributed_count;
+        uint16_t _repeat_ms;
+        uint8_t _min_trits;
+        uint8_t _top_size;
+
+        static_assert(WIDTH_BITS >= 1 && WIDTH_BITS <= 15, "HT600TrafficStats: WIDTH_BITS must be 1 to 15");
+        static_assert(DEPTH >= 1 && DEPTH <= 8, "HT600TrafficStats: DEPTH must be 1 to 8");
+        static_assert(TOP_K >= 1 && TOP_K < 255, "HT600TrafficStats: TOP_K must be 1 to 254");
+};
+
+#endif